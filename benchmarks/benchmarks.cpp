@@ -0,0 +1,529 @@
+#include "../include/simple_json.h"
+#include "../include/simple_json_compact.h"
+#include "../include/simple_json_index.h"
+#include "../include/simple_json_parallel.h"
+#include "../include/simple_json_path.h"
+#include "../include/simple_json_tape.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace simple_json;
+
+namespace
+{
+
+// All generated corpora are top level JSON objects so that they can also be
+// fed to operator>> (which expects the input to start with '{').
+std::string
+generate_numeric_corpus ()
+{
+  std::mt19937_64 generator{ 42 };
+  std::uniform_real_distribution<double> real{ -1.0e6, 1.0e6 };
+  std::uniform_int_distribution<int> integer{ -100000, 100000 };
+  std::ostringstream oss;
+  oss.precision (17);
+  oss << "{\"values\": [";
+  for (size_t i{}; i < 100000; ++i)
+    {
+      if (i != 0)
+        oss << ", ";
+      if (i % 2 == 0)
+        oss << real (generator);
+      else
+        oss << integer (generator);
+    }
+  oss << "]}";
+  return oss.str ();
+}
+
+std::string
+generate_string_corpus ()
+{
+  static constexpr std::string_view alphabet{
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 .,;-_"
+  };
+  std::mt19937_64 generator{ 43 };
+  std::uniform_int_distribution<size_t> length{ 1, 256 };
+  std::uniform_int_distribution<size_t> character{ 0, alphabet.size () - 1 };
+  std::string corpus{ "{\"strings\": [" };
+  for (size_t i{}; i < 20000; ++i)
+    {
+      if (i != 0)
+        corpus += ", ";
+      corpus += '"';
+      for (size_t j{}, n{ length (generator) }; j < n; ++j)
+        corpus += alphabet[character (generator)];
+      corpus += '"';
+    }
+  corpus += "]}";
+  return corpus;
+}
+
+std::string
+generate_nested_corpus ()
+{
+  static constexpr size_t depth{ 500 };
+  std::string corpus;
+  for (size_t i{}; i < depth; ++i)
+    corpus += i % 2 == 0 ? "{\"level\": " : "[1, \"x\", ";
+  corpus += "null";
+  for (size_t i{ depth }; i-- > 0;)
+    corpus += i % 2 == 0 ? "}" : "]";
+  return corpus;
+}
+
+std::string
+generate_wide_object_corpus ()
+{
+  std::string corpus{ "{" };
+  for (size_t i{}; i < 50000; ++i)
+    {
+      if (i != 0)
+        corpus += ", ";
+      corpus += std::format ("\"key_{}\": {}", i, i);
+    }
+  corpus += "}";
+  return corpus;
+}
+
+std::string
+generate_twitter_corpus ()
+{
+  std::mt19937_64 generator{ 44 };
+  std::uniform_int_distribution<std::uint64_t> id{ 100000000000,
+                                                   999999999999 };
+  std::uniform_int_distribution<int> count{ 0, 5000 };
+  std::string corpus{ "{\"statuses\": [" };
+  for (size_t i{}; i < 2000; ++i)
+    {
+      if (i != 0)
+        corpus += ", ";
+      corpus += std::format (
+          R"({{"id": {}, "created_at": "Sun Aug 31 00:29:15 +0000 2014", )"
+          R"("text": "status number {} with some #hashtags and a link", )"
+          R"("truncated": false, "retweet_count": {}, "favorite_count": {}, )"
+          R"("favorited": false, "retweeted": true, "lang": "en", )"
+          R"("in_reply_to_status_id": null, )"
+          R"("entities": {{"hashtags": [{{"text": "json", )"
+          R"("indices": [28, 33]}}], "urls": [], "user_mentions": []}}, )"
+          R"("user": {{"id": {}, "name": "user {}", "screen_name": "u{}", )"
+          R"("location": "Earth", "followers_count": {}, )"
+          R"("friends_count": {}, "verified": false, )"
+          R"("profile_image_url": "http://example.com/{}.png"}}}})",
+          id (generator), i, count (generator), count (generator),
+          id (generator), i, i, count (generator), count (generator), i);
+    }
+  corpus += "]}";
+  return corpus;
+}
+
+std::string
+load_sample_corpus ()
+{
+  std::ifstream input_file{ SIMPLE_JSON_SAMPLE_JSON, std::ios::in };
+  return std::string{ std::istreambuf_iterator<char>{ input_file },
+                      std::istreambuf_iterator<char>{} };
+}
+
+const std::string &
+corpus (const std::string_view name)
+{
+  static const std::unordered_map<std::string_view, std::string> corpora{
+    { "numeric", generate_numeric_corpus () },
+    { "strings", generate_string_corpus () },
+    { "nested", generate_nested_corpus () },
+    { "wide_object", generate_wide_object_corpus () },
+    { "twitter", generate_twitter_corpus () },
+    { "sample", load_sample_corpus () }
+  };
+  return corpora.at (name);
+}
+
+Json
+parsed_corpus (const std::string_view name)
+{
+  return parse (corpus (name)).result_value.value ();
+}
+
+void
+parse_benchmark (benchmark::State &state, const std::string_view name)
+{
+  const std::string &input{ corpus (name) };
+  for (auto _ : state)
+    {
+      auto result{ parse (input) };
+      benchmark::DoNotOptimize (result);
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (state.iterations ())
+                           * static_cast<int64_t> (input.size ()));
+}
+
+void
+parse_validating_utf8_benchmark (benchmark::State &state,
+                                 const std::string_view name)
+{
+  const std::string &input{ corpus (name) };
+  const parse_options options{ .validate_utf8 = true };
+  for (auto _ : state)
+    {
+      auto result{ parse (input, options) };
+      benchmark::DoNotOptimize (result);
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (state.iterations ())
+                           * static_cast<int64_t> (input.size ()));
+}
+
+void
+parse_tape_benchmark (benchmark::State &state, const std::string_view name)
+{
+  const std::string &input{ corpus (name) };
+  for (auto _ : state)
+    {
+      auto tape{ parse_tape (input) };
+      benchmark::DoNotOptimize (tape);
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (state.iterations ())
+                           * static_cast<int64_t> (input.size ()));
+}
+
+// Parse the numeric corpus and sum its values, through Json elements
+// (argument 0) or through a json_number_array (argument 1).
+void
+numeric_array_benchmark (benchmark::State &state)
+{
+  const std::string &input{ corpus ("numeric") };
+  const parse_options options{ .typed_numeric_arrays = state.range (0) == 1 };
+  for (auto _ : state)
+    {
+      const Json json = parse (input, options).result_value.value ();
+      const Json &values{ json.at ("values") };
+      double sum{};
+      if (const auto numbers = values.get_json_value_as_numbers ())
+        sum = sum_numbers (*numbers);
+      else
+        {
+          for (const Json &value : values.values ())
+            sum += value.to_number ();
+        }
+      benchmark::DoNotOptimize (sum);
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (state.iterations ())
+                           * static_cast<int64_t> (input.size ()));
+}
+
+// Parse, change one value and serialize again, with lazy numbers when the
+// argument is 1.
+void
+round_trip_benchmark (benchmark::State &state, const std::string_view name)
+{
+  const std::string &input{ corpus (name) };
+  const parse_options options{ .lazy_numbers = state.range (0) == 1 };
+  for (auto _ : state)
+    {
+      Json json = parse (input, options).result_value.value ();
+      json["edited"] = Json{ true };
+      benchmark::DoNotOptimize (json.to_string ());
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (state.iterations ())
+                           * static_cast<int64_t> (input.size ()));
+}
+
+// Small messages parsed with parse () (argument 0) or with one reused
+// parser that gets every result back (argument 1).
+void
+small_message_benchmark (benchmark::State &state)
+{
+  const std::string_view message{
+    R"({"id": 12345, "user": {"name": "a fairly long user name here",)"
+    R"( "tags": ["alpha", "beta", "gamma"]}, "values": [1, 2, 3, 4.5]})"
+  };
+  parser json_parser;
+  for (auto _ : state)
+    {
+      if (state.range (0) == 0)
+        {
+          auto result{ parse (message) };
+          benchmark::DoNotOptimize (result);
+        }
+      else
+        {
+          auto result{ json_parser.parse (message) };
+          benchmark::DoNotOptimize (result);
+          json_parser.recycle (std::move (*result.result_value));
+        }
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (state.iterations ())
+                           * static_cast<int64_t> (message.size ()));
+}
+
+void
+parse_selected_benchmark (benchmark::State &state)
+{
+  const std::string &input{ corpus ("twitter") };
+  const std::vector<std::string> pointers{ "/statuses/1000/id",
+                                           "/statuses/1500/user/name",
+                                           "/statuses/1999/retweet_count" };
+  for (auto _ : state)
+    {
+      auto result{ parse_selected (input, pointers) };
+      benchmark::DoNotOptimize (result);
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (state.iterations ())
+                           * static_cast<int64_t> (input.size ()));
+}
+
+void
+stream_extraction_benchmark (benchmark::State &state,
+                             const std::string_view name)
+{
+  // operator>> expects the opening curly brace on a line of its own.
+  const std::string input{ "{\n" + corpus (name).substr (1) };
+  for (auto _ : state)
+    {
+      std::istringstream iss{ input };
+      Json json;
+      iss >> json;
+      benchmark::DoNotOptimize (json);
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (state.iterations ())
+                           * static_cast<int64_t> (input.size ()));
+}
+
+void
+serialize_benchmark (benchmark::State &state, const std::string_view name)
+{
+  const Json json = parsed_corpus (name);
+  const int indent{ static_cast<int> (state.range (0)) };
+  size_t bytes{};
+  for (auto _ : state)
+    {
+      std::string output{ json.to_string (indent) };
+      bytes += output.size ();
+      benchmark::DoNotOptimize (output);
+    }
+  state.SetBytesProcessed (static_cast<int64_t> (bytes));
+}
+
+// One small write per iteration to a shared document: only the path from
+// the root to the modified status is serialized again.
+void
+incremental_serialize_benchmark (benchmark::State &state)
+{
+  Json json = parsed_corpus ("twitter");
+  json.share ();
+  const int indent{ static_cast<int> (state.range (0)) };
+  int64_t counter{};
+  for (auto _ : state)
+    {
+      auto &statuses{ json["statuses"].get_json_value_as_array ()->get () };
+      statuses[counter % statuses.size ()]["retweet_count"]
+          = Json{ static_cast<double> (counter) };
+      ++counter;
+      std::string output{ json.to_string (indent) };
+      benchmark::DoNotOptimize (output);
+      json.share ();
+    }
+}
+
+void
+lookup_subscript_benchmark (benchmark::State &state)
+{
+  const Json json = parsed_corpus ("twitter");
+  const auto &statuses{ json.get_child_as_json_array ("statuses")->get () };
+  size_t i{};
+  for (auto _ : state)
+    {
+      const Json &status{ statuses[i++ % statuses.size ()] };
+      benchmark::DoNotOptimize (status["user"]["followers_count"]);
+    }
+}
+
+void
+lookup_at_benchmark (benchmark::State &state)
+{
+  const Json json = parsed_corpus ("twitter");
+  const auto &statuses{ json.get_child_as_json_array ("statuses")->get () };
+  size_t i{};
+  for (auto _ : state)
+    {
+      const Json &status{ statuses[i++ % statuses.size ()] };
+      benchmark::DoNotOptimize (status.at ("user").at ("followers_count"));
+    }
+}
+
+void
+lookup_get_child_benchmark (benchmark::State &state)
+{
+  const Json json = parsed_corpus ("twitter");
+  const auto &statuses{ json.get_child_as_json_array ("statuses")->get () };
+  size_t i{};
+  for (auto _ : state)
+    {
+      const Json &status{ statuses[i++ % statuses.size ()] };
+      benchmark::DoNotOptimize (status.get_child_as_json_number ("id"));
+      benchmark::DoNotOptimize (status.get_child_as_json_string ("text"));
+      benchmark::DoNotOptimize (
+          status.get_child_as_json_boolean ("retweeted"));
+      benchmark::DoNotOptimize (status.get_child_as_json_object ("user"));
+      benchmark::DoNotOptimize (
+          status.get_child_as_json_object ("entities"));
+    }
+}
+
+void
+traversal_benchmark (benchmark::State &state)
+{
+  const Json json = parsed_corpus ("twitter");
+  const auto &statuses{ json.get_child_as_json_array ("statuses")->get () };
+  const compact_document document{ json };
+  const auto compact_statuses{
+    *document["statuses"].get_json_value_as_array ()
+  };
+  for (auto _ : state)
+    {
+      double sum{};
+      if (state.range (0) == 0)
+        {
+          for (const Json &status : statuses)
+            sum += status["user"]["followers_count"].to_number ();
+        }
+      else
+        {
+          for (const compact_json &status : compact_statuses)
+            sum += status["user"]["followers_count"].to_number ();
+        }
+      benchmark::DoNotOptimize (sum);
+    }
+  state.counters["resident_bytes"] = static_cast<double> (
+      state.range (0) == 0 ? 0 : document.allocated_bytes ());
+}
+
+// Look up statuses by user screen name, scanning the array (argument 0) or
+// through a json_index (argument 1).
+void
+index_lookup_benchmark (benchmark::State &state)
+{
+  Json json = parsed_corpus ("twitter");
+  Json &statuses{ json.get_json_value_as_object ()->get ().at ("statuses") };
+  const json_index index{ statuses, "/user/screen_name" };
+  const auto &elements{
+    std::as_const (statuses).get_json_value_as_array ()->get ()
+  };
+  size_t i{};
+  for (auto _ : state)
+    {
+      const std::string name{ std::format ("u{}", i++ % elements.size ()) };
+      const Json *found{};
+      if (state.range (0) == 0)
+        {
+          for (const Json &status : elements)
+            if (status["user"].get_child_as_json_string ("screen_name")
+                    ->get ()
+                == name)
+              {
+                found = &status;
+                break;
+              }
+        }
+      else
+        found = index.find (name);
+      benchmark::DoNotOptimize (found);
+    }
+}
+
+// Screen names of popular statuses, with a hand-written loop (argument 0)
+// or a compiled JSONPath query (argument 1).
+void
+json_path_benchmark (benchmark::State &state)
+{
+  const Json json = parsed_corpus ("twitter");
+  const json_path query{
+    "$.statuses[?@.retweet_count > 2500].user.screen_name"
+  };
+  for (auto _ : state)
+    {
+      std::vector<const Json *> names;
+      if (state.range (0) == 0)
+        {
+          for (const Json &status :
+               json.get_child_as_json_array ("statuses")->get ())
+            if (status["retweet_count"].to_number () > 2500)
+              names.push_back (&status["user"]["screen_name"]);
+        }
+      else
+        names = query.select (json);
+      benchmark::DoNotOptimize (names);
+    }
+}
+
+void
+parallel_reduce_benchmark (benchmark::State &state)
+{
+  const Json json = parsed_corpus ("numeric");
+  const Json &values{ json.at ("values") };
+  for (auto _ : state)
+    {
+      double sum{};
+      if (state.range (0) == 0)
+        {
+          for (const Json &value : values.values ())
+            sum += value.to_number ();
+        }
+      else
+        sum = parallel_reduce (
+            values, 0.0, std::plus<> (),
+            [] (const Json &value) { return value.to_number (); });
+      benchmark::DoNotOptimize (sum);
+    }
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE (parse_benchmark, numeric, "numeric");
+BENCHMARK_CAPTURE (parse_benchmark, strings, "strings");
+BENCHMARK_CAPTURE (parse_benchmark, nested, "nested");
+BENCHMARK_CAPTURE (parse_benchmark, wide_object, "wide_object");
+BENCHMARK_CAPTURE (parse_benchmark, twitter, "twitter");
+BENCHMARK_CAPTURE (parse_benchmark, sample, "sample");
+BENCHMARK_CAPTURE (parse_validating_utf8_benchmark, strings, "strings");
+BENCHMARK_CAPTURE (parse_validating_utf8_benchmark, twitter, "twitter");
+BENCHMARK_CAPTURE (parse_tape_benchmark, numeric, "numeric");
+BENCHMARK_CAPTURE (parse_tape_benchmark, twitter, "twitter");
+BENCHMARK (parse_selected_benchmark);
+BENCHMARK (small_message_benchmark)->Arg (0)->Arg (1);
+BENCHMARK (numeric_array_benchmark)->Arg (0)->Arg (1);
+BENCHMARK_CAPTURE (round_trip_benchmark, numeric, "numeric")->Arg (0)->Arg (1);
+BENCHMARK_CAPTURE (round_trip_benchmark, twitter, "twitter")->Arg (0)->Arg (1);
+
+BENCHMARK_CAPTURE (stream_extraction_benchmark, numeric, "numeric");
+BENCHMARK_CAPTURE (stream_extraction_benchmark, twitter, "twitter");
+BENCHMARK_CAPTURE (stream_extraction_benchmark, sample, "sample");
+
+BENCHMARK_CAPTURE (serialize_benchmark, numeric, "numeric")->Arg (0)->Arg (2);
+BENCHMARK_CAPTURE (serialize_benchmark, strings, "strings")->Arg (0)->Arg (2);
+BENCHMARK_CAPTURE (serialize_benchmark, nested, "nested")->Arg (0)->Arg (2);
+BENCHMARK_CAPTURE (serialize_benchmark, wide_object, "wide_object")
+    ->Arg (0)
+    ->Arg (2);
+BENCHMARK_CAPTURE (serialize_benchmark, twitter, "twitter")->Arg (0)->Arg (2);
+BENCHMARK_CAPTURE (serialize_benchmark, sample, "sample")->Arg (0)->Arg (2);
+
+BENCHMARK (incremental_serialize_benchmark)->Arg (0)->Arg (2);
+
+BENCHMARK (lookup_subscript_benchmark);
+BENCHMARK (lookup_at_benchmark);
+BENCHMARK (lookup_get_child_benchmark);
+BENCHMARK (traversal_benchmark)->Arg (0)->Arg (1);
+BENCHMARK (json_path_benchmark)->Arg (0)->Arg (1);
+BENCHMARK (index_lookup_benchmark)->Arg (0)->Arg (1);
+
+BENCHMARK (parallel_reduce_benchmark)->Arg (0)->Arg (1);
+
+BENCHMARK_MAIN ();
@@ -6,20 +6,31 @@
 #define SIMPLE_JSON_H
 
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <charconv>
+#include <chrono>
 #include <format>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <ostream>
+#include <ranges>
+#include <span>
 #include <sstream>
 
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <variant>
 #include <vector>
 
+
 namespace simple_json
 {
 
@@ -54,28 +65,157 @@ len (const CharType (&src)[N]) noexcept
 }
 
 bool is_whitespace (char ch);
-void skip_whitespace (const std::string &str, size_t &pos);
+void skip_whitespace (std::string_view str, size_t &pos);
 
 class Json;
 
+// Digits of a number as they appeared in the input, kept by
+// parse_options::lazy_numbers. Converted to double on each access and
+// printed unchanged until the value is replaced.
+struct json_raw_number
+{
+  std::string text;
+};
+
+// Array whose elements are all numbers, stored contiguously when parsing
+// with parse_options::typed_numeric_arrays. It is a JSON array like
+// std::vector<Json>: the const array accessors of Json see its elements as
+// numbers (built once, on first use), the non-const ones turn it into a
+// std::vector<Json> first.
+struct json_number_array
+{
+  json_number_array () = default;
+
+  explicit json_number_array (std::vector<double> values) noexcept
+      : numbers{ std::move (values) }
+  {
+  }
+
+  json_number_array (const json_number_array &other)
+      : numbers{ other.numbers }, element_cache{ other.element_cache.load (
+                                      std::memory_order_acquire) }
+  {
+  }
+
+  json_number_array (json_number_array &&other) noexcept
+      : numbers{ std::move (other.numbers) },
+        element_cache{ other.element_cache.exchange (nullptr) }
+  {
+  }
+
+  json_number_array &
+  operator= (json_number_array other) noexcept
+  {
+    numbers = std::move (other.numbers);
+    element_cache.store (other.element_cache.exchange (nullptr));
+    return *this;
+  }
+
+  // The values as Json elements; thread safe.
+  const std::vector<Json> &elements () const;
+
+  const std::vector<double> &
+  values () const noexcept
+  {
+    return numbers;
+  }
+
+  // Drops the elements built so far, as they no longer match.
+  std::vector<double> &
+  mutable_values () noexcept
+  {
+    element_cache.store (nullptr);
+    return numbers;
+  }
+
+private:
+  std::vector<double> numbers;
+  mutable std::atomic<std::shared_ptr<const std::vector<Json> > >
+      element_cache;
+};
+
 using JSONValue
     = std::variant<std::nullptr_t, bool, double, std::string,
-                   std::vector<Json>, std::unordered_map<std::string, Json> >;
+                   std::vector<Json>, std::unordered_map<std::string, Json>,
+                   json_raw_number, json_number_array>;
 
 struct result_type;
 
-result_type parse (const std::string &input);
+// Opt-in parser behaviour; the defaults give the same result as
+// parse (input).
+struct parse_options
+{
+  bool validate_utf8{}; // fail on strings that are not well-formed UTF-8
+  bool lazy_numbers{};  // store numbers as json_raw_number
+  // store arrays of only numbers as json_number_array (unless lazy_numbers)
+  bool typed_numeric_arrays{};
+
+  // Limits for untrusted input, 0 meaning no limit. The parse stops at the
+  // first limit exceeded, with an error naming it and the input offset;
+  // like other errors inside arrays and objects, a limit hit there is
+  // thrown as std::invalid_argument.
+  size_t max_depth{};           // nesting of arrays and objects
+  size_t max_input_bytes{};
+  size_t max_string_length{};   // bytes, keys included
+  size_t max_element_count{};   // values in the whole document
+  size_t max_allocated_bytes{}; // estimated heap use of the parsed tree
+  // Checked once every 4096 values.
+  std::optional<std::chrono::steady_clock::time_point> deadline{};
+};
 
-result_type parseValue (const std::string &str, size_t &pos);
-result_type parse_json_object (const std::string &str, size_t &pos);
-result_type parse_json_array (const std::string &str, size_t &pos);
-result_type parse_json_string (const std::string &str, size_t &pos);
-result_type parse_json_number (const std::string &str, size_t &pos);
+result_type parse (std::string_view input);
+result_type parse (std::string_view input, const parse_options &options);
+
+// Input in other encodings is transcoded to UTF-8 first (char8_t input is
+// used as is); malformed input fails. wchar_t is UTF-16 or UTF-32
+// depending on its size.
+result_type parse (std::u8string_view input,
+                   const parse_options &options = {});
+result_type parse (std::u16string_view input,
+                   const parse_options &options = {});
+result_type parse (std::u32string_view input,
+                   const parse_options &options = {});
+result_type parse (std::wstring_view input, const parse_options &options = {});
+
+// Checks 16 bytes per step while the input is ASCII.
+bool is_valid_utf8 (std::string_view str) noexcept;
+
+// Reductions over contiguous numbers, e.g. Json::get_json_value_as_numbers
+// (). They keep independent partial results the compiler turns into SIMD
+// lanes, so sums may differ from a sequential sum in the last bits. min and
+// max of no numbers are NaN.
+double sum_numbers (std::span<const double> numbers) noexcept;
+double min_number (std::span<const double> numbers) noexcept;
+double max_number (std::span<const double> numbers) noexcept;
+
+result_type parseValue (std::string_view str, size_t &pos);
+result_type parse_json_object (std::string_view str, size_t &pos);
+result_type parse_json_array (std::string_view str, size_t &pos);
+result_type parse_json_string (std::string_view str, size_t &pos);
+result_type parse_json_number (std::string_view str, size_t &pos);
+
+// Parses only the values at the given JSON pointers. Everything else is
+// skipped with skip_json_value () without building nodes, and parsing stops
+// as soon as every pointer has been resolved. The result is an object
+// mapping each pointer found in input to its value. Since later members are
+// never seen, a key repeated in an object selects its first member, whereas
+// parse () keeps the last one.
+result_type parse_selected (std::string_view input,
+                            const std::vector<std::string> &pointers);
+
+// Advances pos past the value starting at pos by matching quotes and
+// brackets only: nothing is decoded or validated. Returns false if the
+// value is unterminated.
+bool skip_json_value (std::string_view str, size_t &pos);
 void print_value (const JSONValue &val, std::ostream &os, int indent,
                   int level);
+void print_json (const Json &json, std::ostream &os, int indent, int level);
 void print_helper (std::nullptr_t, std::ostream &os, int, int);
 void print_helper (bool b, std::ostream &os, int, int);
 void print_helper (double d, std::ostream &os, int, int);
+void print_helper (const json_raw_number &number, std::ostream &os, int, int);
+void print_helper (const json_number_array &json_array, std::ostream &os,
+                   int indent, int level);
 void print_helper (const std::string &s, std::ostream &os, int, int);
 void print_helper (const std::vector<Json> &json_array, std::ostream &os,
                    int indent, int level);
@@ -85,6 +225,16 @@ void print_helper (const std::unordered_map<std::string, Json> &json_object,
 std::ostream &operator<< (std::ostream &os, const Json &json);
 std::istream &operator>> (std::istream &is, Json &json);
 
+// RFC 6901 JSON Pointer helpers. A pointer is either "" (the whole document)
+// or a sequence of '/' prefixed reference tokens in which '~' and '/' are
+// escaped as "~0" and "~1". Malformed pointers throw std::invalid_argument.
+std::vector<std::string> split_json_pointer (std::string_view pointer);
+std::string append_json_pointer (std::string_view pointer,
+                                 std::string_view token);
+std::optional<size_t> json_pointer_index (std::string_view token);
+const Json *find_json_pointer (const Json &json, std::string_view pointer);
+Json *find_json_pointer (Json &json, std::string_view pointer);
+
 enum class status
 {
   success,
@@ -101,6 +251,35 @@ enum class json_type : unsigned
   object_t
 };
 
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+enum class json_operation
+{
+  parse,
+  serialize
+};
+
+// Collected per top level parse () / serialization call when the library is
+// built with SIMPLE_JSON_ENABLE_STATISTICS. Allocation figures are estimated
+// from the sizes and capacities of the containers and strings being built.
+struct json_statistics
+{
+  json_operation operation{};
+  size_t bytes_processed{};
+  std::chrono::nanoseconds elapsed{};
+  std::array<size_t, 6> node_counts{}; // indexed by json_type
+  size_t max_depth{};
+  size_t allocation_count{};
+  size_t allocated_bytes{};
+  size_t largest_string{};
+  size_t largest_array{};
+  size_t largest_object{};
+};
+
+void set_statistics_callback (
+    std::function<void (const json_statistics &)> callback);
+const json_statistics &last_statistics () noexcept;
+#endif
+
 class Json
 {
 
@@ -110,6 +289,14 @@ public:
     std::unordered_map<const std::string, Json>::iterator json_object_iterator;
 
   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<const std::string, Json>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+
+    iterator () = default;
+
     // explicit iterator (std::nullptr_t) : json_object_iterator (nullptr) {}
     explicit iterator (std::unordered_map<const std::string, Json>::iterator iter)
         : json_object_iterator{ iter }
@@ -132,12 +319,6 @@ public:
     }
 
     std::pair<const std::string, Json> &
-    operator* ()
-    {
-      return *json_object_iterator;
-    }
-
-    const std::pair<const std::string, Json> &
     operator* () const
     {
       return *json_object_iterator;
@@ -173,6 +354,14 @@ public:
     std::unordered_map<std::string, Json>::const_iterator json_object_iterator;
 
   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<const std::string, Json>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    const_iterator () = default;
+
     // explicit const_iterator (std::nullptr_t) : json_object_iterator (nullptr) { }
     explicit const_iterator (std::unordered_map<std::string, Json>::const_iterator iter)
         : json_object_iterator{ iter }
@@ -219,54 +408,177 @@ public:
     }
   };
 
+  // Iterates the elements of an array or the member values of an object;
+  // scalars form an empty range.
+  template <bool IsConst> class basic_value_iterator
+  {
+    using array_iterator
+        = std::conditional_t<IsConst, std::vector<Json>::const_iterator,
+                             std::vector<Json>::iterator>;
+    using object_iterator = std::conditional_t<
+        IsConst, std::unordered_map<std::string, Json>::const_iterator,
+        std::unordered_map<std::string, Json>::iterator>;
+
+    array_iterator json_array_iterator{};
+    object_iterator json_object_iterator{};
+    bool is_object{};
+
+  public:
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Json;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const Json *, Json *>;
+    using reference = std::conditional_t<IsConst, const Json &, Json &>;
+
+    basic_value_iterator () = default;
+
+    explicit basic_value_iterator (array_iterator iter)
+        : json_array_iterator{ iter }
+    {
+    }
+
+    explicit basic_value_iterator (object_iterator iter)
+        : json_object_iterator{ iter }, is_object{ true }
+    {
+    }
+
+    reference
+    operator* () const
+    {
+      return is_object ? json_object_iterator->second : *json_array_iterator;
+    }
+
+    pointer
+    operator->() const
+    {
+      return &**this;
+    }
+
+    basic_value_iterator &
+    operator++ ()
+    {
+      if (is_object)
+        ++json_object_iterator;
+      else
+        ++json_array_iterator;
+      return *this;
+    }
+
+    basic_value_iterator
+    operator++ (int)
+    {
+      basic_value_iterator tmp{ *this };
+      ++(*this);
+      return tmp;
+    }
+
+    bool
+    operator== (const basic_value_iterator &rhs) const noexcept
+    {
+      return is_object == rhs.is_object
+             && (is_object ? json_object_iterator == rhs.json_object_iterator
+                           : json_array_iterator == rhs.json_array_iterator);
+    }
+  };
+
+  using value_iterator = basic_value_iterator<false>;
+  using const_value_iterator = basic_value_iterator<true>;
+
+  // begin () / end () iterate object members, like items (), and form an
+  // empty range for arrays and scalars: a member iterator has no key to
+  // hand out for an array element. Use values () to iterate array elements.
   iterator
   begin ()
   {
-    if (is_json_object ())
-      return iterator{ get_json_value_as_object ().value().get().begin() };
-
-    return iterator{ get_json_value_as_unordered_map().begin() };
+    return iterator{ object_members ().begin () };
   }
 
   const_iterator
   begin () const
   {
-    if (is_json_object ())
-      return const_iterator{ std::as_const (*this).get_json_value_as_object().value().get().cbegin() };
-    return const_iterator{ std::as_const(*this).get_json_value_as_unordered_map().cbegin() };
+    return const_iterator{ object_members ().cbegin () };
   }
 
   iterator
   end ()
   {
-    if (is_json_object ())
-      return iterator{ get_json_value_as_object ().value().get().end() };
-
-    return iterator{ get_json_value_as_unordered_map().end() };
+    return iterator{ object_members ().end () };
   }
 
   const_iterator
   end () const
   {
-    if (is_json_object ())
-      return const_iterator{ std::as_const (*this).get_json_value_as_object().value().get().cend() };
-    return const_iterator{ std::as_const(*this).get_json_value_as_unordered_map().cend() };
+    return const_iterator{ object_members ().cend () };
   }
 
   const_iterator
   cbegin () const
   {
-    if (is_json_object ())
-      return const_iterator{ std::as_const (*this).get_json_value_as_object().value().get().cbegin() };
-    return const_iterator{ std::as_const(*this).get_json_value_as_unordered_map().cbegin() };
+    return begin ();
   }
 
   const_iterator
   cend () const
   {
-    if (is_json_object ())
-      return const_iterator{ std::as_const (*this).get_json_value_as_object().value().get().cend() };
-    return const_iterator{ std::as_const(*this).get_json_value_as_unordered_map().cend() };
+    return end ();
+  }
+
+  // Lazy views, usable with std::ranges algorithms and adaptors without
+  // copying any element.
+  auto
+  values ()
+  {
+    using view = std::ranges::subrange<value_iterator>;
+    if (auto json_array = get_json_value_as_array ())
+      return view{ value_iterator{ json_array->get ().begin () },
+                   value_iterator{ json_array->get ().end () } };
+    if (auto json_object = get_json_value_as_object ())
+      return view{ value_iterator{ json_object->get ().begin () },
+                   value_iterator{ json_object->get ().end () } };
+    return view{};
+  }
+
+  auto
+  values () const
+  {
+    using view = std::ranges::subrange<const_value_iterator>;
+    if (auto json_array = get_json_value_as_array ())
+      return view{ const_value_iterator{ json_array->get ().cbegin () },
+                   const_value_iterator{ json_array->get ().cend () } };
+    if (auto json_object = get_json_value_as_object ())
+      return view{ const_value_iterator{ json_object->get ().cbegin () },
+                   const_value_iterator{ json_object->get ().cend () } };
+    return view{};
+  }
+
+  auto
+  items ()
+  {
+    auto &members{ object_members () };
+    return std::ranges::subrange{ members.begin (), members.end () };
+  }
+
+  auto
+  items () const
+  {
+    const auto &members{ object_members () };
+    return std::ranges::subrange{ members.cbegin (), members.cend () };
+  }
+
+  auto
+  keys () const
+  {
+    return items () | std::views::keys;
+  }
+
+  // Numeric value of every element (NaN for non-numbers).
+  auto
+  as_numbers () const
+  {
+    return values ()
+           | std::views::transform (
+               [] (const Json &element) { return element.to_number (); });
   }
 
   explicit Json () : value{ nullptr } {}
@@ -274,8 +586,11 @@ public:
   explicit Json (const bool b) : value{ b } {}
   explicit Json (const int n) : value (static_cast<double> (n)) {}
   explicit Json (const double d) : value{ d } {}
+  explicit Json (json_raw_number number) : value{ std::move (number) } {}
+  explicit Json (json_number_array numbers) : value{ std::move (numbers) } {}
   explicit Json (const char *s) : value{ std::string{ s } } {}
   explicit Json (const std::string &s) : value{ s } {}
+  explicit Json (std::string &&s) : value{ std::move (s) } {}
   explicit Json (const std::vector<Json> &values) : value{ values } {}
 
   explicit Json (std::vector<Json> &&values)
@@ -299,7 +614,7 @@ public:
   get_json_value_as_null () const
   {
     if (is_json_null ())
-      return std::make_optional (std::get<std::nullptr_t> (value));
+      return std::make_optional (std::get<std::nullptr_t> (data ()));
     return std::nullopt;
   }
 
@@ -307,7 +622,7 @@ public:
   get_json_value_as_bool () const
   {
     if (is_json_boolean ())
-      return std::make_optional (std::get<bool> (value));
+      return std::make_optional (std::get<bool> (data ()));
     return std::nullopt;
   }
 
@@ -315,7 +630,7 @@ public:
   get_json_value_as_number () const
   {
     if (is_json_number ())
-      return std::make_optional (std::get<double> (value));
+      return std::make_optional (to_number ());
     return std::nullopt;
   }
 
@@ -324,7 +639,7 @@ public:
   {
     if (is_json_string ())
       return std::make_optional<std::reference_wrapper<std::string> > (
-          std::ref (std::get<std::string> (value)));
+          std::ref (std::get<std::string> (mutable_data ())));
     return std::nullopt;
   }
 
@@ -333,26 +648,48 @@ public:
   {
     if (is_json_string ())
       return std::make_optional<std::reference_wrapper<const std::string> > (
-          std::cref (std::get<std::string> (value)));
+          std::cref (std::get<std::string> (data ())));
     return std::nullopt;
   }
 
+  // Converts a json_number_array into a std::vector<Json>.
   std::optional<std::reference_wrapper<std::vector<Json> > >
   get_json_value_as_array ()
   {
-    if (is_json_array ())
-      return std::make_optional<std::reference_wrapper<std::vector<Json> > > (
-          std::ref (std::get<std::vector<Json> > (value)));
-    return std::nullopt;
+    if (!is_json_array ())
+      return std::nullopt;
+    if (auto *numbers = std::get_if<json_number_array> (&mutable_data ()))
+      {
+        std::vector<Json> elements;
+        elements.reserve (numbers->values ().size ());
+        for (const double number : numbers->values ())
+          elements.emplace_back (number);
+        value = std::move (elements);
+      }
+    return std::make_optional<std::reference_wrapper<std::vector<Json> > > (
+        std::ref (std::get<std::vector<Json> > (value)));
   }
 
   std::optional<std::reference_wrapper<const std::vector<Json> > >
   get_json_value_as_array () const
   {
+    if (const auto *numbers = std::get_if<json_number_array> (&data ()))
+      return std::make_optional<
+          std::reference_wrapper<const std::vector<Json> > > (
+          std::cref (numbers->elements ()));
     if (is_json_array ())
       return std::make_optional<
           std::reference_wrapper<const std::vector<Json> > > (
-          std::cref (std::get<std::vector<Json> > (value)));
+          std::cref (std::get<std::vector<Json> > (data ())));
+    return std::nullopt;
+  }
+
+  // The elements of a json_number_array, without copying.
+  std::optional<std::span<const double> >
+  get_json_value_as_numbers () const noexcept
+  {
+    if (const auto *numbers = std::get_if<json_number_array> (&data ()))
+      return std::span<const double>{ numbers->values () };
     return std::nullopt;
   }
 
@@ -363,7 +700,7 @@ public:
     if (is_json_object ())
       return std::make_optional<
           std::reference_wrapper<std::unordered_map<std::string, Json> > > (
-          std::ref (std::get<std::unordered_map<std::string, Json> > (value)));
+          std::ref (std::get<std::unordered_map<std::string, Json> > (mutable_data ())));
     return std::nullopt;
   }
 
@@ -375,16 +712,66 @@ public:
       return std::make_optional<std::reference_wrapper<
           const std::unordered_map<std::string, Json> > > (
           std::cref (
-              std::get<std::unordered_map<std::string, Json> > (value)));
+              std::get<std::unordered_map<std::string, Json> > (data ())));
     return std::nullopt;
   }
 
   const JSONValue &
   get_json_value_as_variant () const noexcept
   {
-    return value;
+    return data ();
+  }
+
+  // Switches this subtree to copy-on-write mode: strings, arrays and objects
+  // are moved into reference counted storage, copies of the Json become O(1)
+  // and share every unchanged subtree. Non-const accessors detach (copy one
+  // level of) the node they are called on before handing out references.
+  // Serializing a shared array or object caches its text, so after a few
+  // writes to_string () only regenerates the detached path from the root to
+  // the modified nodes and splices in the cached text of everything else.
+  // Call share () again after a batch of writes to make the new nodes
+  // cacheable too.
+  Json &
+  share ()
+  {
+    if (shared_value)
+      return *this;
+    if (auto *json_array = std::get_if<std::vector<Json> > (&value))
+      {
+        for (auto &element : *json_array)
+          element.share ();
+      }
+    else if (auto *json_object
+             = std::get_if<std::unordered_map<std::string, Json> > (&value))
+      {
+        for (auto &[key, element] : *json_object)
+          element.share ();
+      }
+    if (is_json_string () || is_json_array () || is_json_object ())
+      {
+        shared_value = std::make_shared<shared_node> (std::move (value));
+        value = nullptr;
+      }
+    return *this;
   }
 
+  bool
+  is_shared () const noexcept
+  {
+    return shared_value != nullptr;
+  }
+
+  // Structural hash consistent with operator==: object members are combined
+  // order independently. The hash of a shared subtree is computed once and
+  // cached in its (immutable) shared storage.
+  std::size_t hash () const;
+
+  // Deep comparison. Exits early on differing types, sizes, cached hashes
+  // and treats two Json sharing the same storage as equal without walking.
+  friend bool operator== (const Json &lhs, const Json &rhs);
+  friend void print_json (const Json &json, std::ostream &os, int indent,
+                          int level);
+
   // template <typename T>
   // const T &
   // get () const
@@ -396,22 +783,30 @@ public:
   to_string (int indent = 0) const
   {
     std::ostringstream oss;
-    print_value (value, oss, indent, 0);
+    print_json (*this, oss, indent, 0);
     return oss.str ();
   }
 
-  constexpr double
+  double
   to_number () const noexcept
   {
-    if (is_json_number ())
-      return std::get<double> (value);
+    if (const auto *number = std::get_if<double> (&data ()))
+      return *number;
+    if (const auto *raw_number = std::get_if<json_raw_number> (&data ()))
+      {
+        double number{ std::numeric_limits<double>::quiet_NaN () };
+        std::from_chars (raw_number->text.data (),
+                         raw_number->text.data () + raw_number->text.size (),
+                         number);
+        return number;
+      }
     return std::numeric_limits<double>::quiet_NaN ();
   }
 
-  constexpr bool
+  bool
   to_bool () const noexcept
   {
-    return is_json_boolean () ? std::get<bool> (value) : false;
+    return is_json_boolean () ? std::get<bool> (data ()) : false;
   }
 
   Json &
@@ -420,7 +815,7 @@ public:
     if (!is_json_object ())
       throw std::invalid_argument ("JSON element is not a JSON object!");
     auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (mutable_data ());
     if (!parent_element.contains (key))
       throw std::out_of_range{ std::format (
           "JSON element with key {} is not found!", key) };
@@ -434,7 +829,7 @@ public:
     if (!is_json_object ())
       throw std::invalid_argument ("JSON element is not a JSON object!");
     const auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (data ());
     if (!parent_element.contains (key))
       throw std::out_of_range{ std::format (
           "JSON element with key {} is not found!", key) };
@@ -448,7 +843,7 @@ public:
     if (!is_json_object ())
       return null_json;
     auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (mutable_data ());
     if (!parent_element.contains (key))
       parent_element[key] = null_json;
     return parent_element[key];
@@ -461,7 +856,7 @@ public:
     if (!is_json_object ())
       return null_json;
     const auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (data ());
     if (parent_element.contains (key))
       return parent_element.at (key);
     return null_json;
@@ -476,14 +871,14 @@ public:
       return std::nullopt;
 
     const auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (data ());
 
     if (parent_element.contains (key))
       {
         const auto &child_element = parent_element.at (key);
         return std::make_optional (
             std::cref (std::get<std::unordered_map<std::string, Json> > (
-                child_element.value)));
+                child_element.data ())));
       }
 
     return std::nullopt;
@@ -496,13 +891,13 @@ public:
       return std::nullopt;
 
     const auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (data ());
 
     if (parent_element.contains (key))
       {
         const auto &child_element = parent_element.at (key);
         return std::make_optional (
-            std::cref (std::get<std::vector<Json> > (child_element.value)));
+            std::cref (std::get<std::vector<Json> > (child_element.data ())));
       }
 
     return std::nullopt;
@@ -515,13 +910,13 @@ public:
       return std::nullopt;
 
     const auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (data ());
 
     if (parent_element.contains (key))
       {
         const auto &child_element = parent_element.at (key);
         return std::make_optional (
-            std::cref (std::get<std::string> (child_element.value)));
+            std::cref (std::get<std::string> (child_element.data ())));
       }
 
     return std::nullopt;
@@ -535,13 +930,15 @@ public:
       return std::nullopt;
 
     const auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (data ());
 
     if (parent_element.contains (key))
       {
         const auto &child_element = parent_element.at (key);
+        if (std::get_if<json_raw_number> (&child_element.data ()))
+          return std::make_optional<double> (child_element.to_number ());
         return std::make_optional<double> (
-            std::get<double> (child_element.value));
+            std::get<double> (child_element.data ()));
       }
 
     return std::nullopt;
@@ -554,12 +951,12 @@ public:
       return std::nullopt;
 
     const auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (data ());
 
     if (parent_element.contains (key))
       {
         const auto &child_element = parent_element.at (key);
-        return std::make_optional<bool> (std::get<bool> (child_element.value));
+        return std::make_optional<bool> (std::get<bool> (child_element.data ()));
       }
 
     return std::nullopt;
@@ -572,74 +969,76 @@ public:
       return std::nullopt;
 
     const auto &parent_element
-        = std::get<std::unordered_map<std::string, Json> > (value);
+        = std::get<std::unordered_map<std::string, Json> > (data ());
 
     if (parent_element.contains (key))
       {
         const auto &child_element = parent_element.at (key);
         return std::make_optional<std::nullptr_t> (
-            std::get<std::nullptr_t> (child_element.value));
+            std::get<std::nullptr_t> (child_element.data ()));
       }
 
     return std::nullopt;
   }
 
-  constexpr json_type
+  json_type
   get_json_element_type () const noexcept
   {
-    if (get_if<std::unordered_map<std::string, Json> > (&value))
+    if (get_if<std::unordered_map<std::string, Json> > (&data ()))
       return json_type::object_t;
 
-    if (std::get_if<std::vector<Json> > (&value))
+    if (is_json_array ())
       return json_type::array_t;
 
-    if (std::get_if<std::string> (&value))
+    if (std::get_if<std::string> (&data ()))
       return json_type::string_t;
 
-    if (std::get_if<double> (&value))
+    if (is_json_number ())
       return json_type::number_t;
 
-    if (std::get_if<bool> (&value))
+    if (std::get_if<bool> (&data ()))
       return json_type::boolean_t;
 
     return json_type::null_t;
   }
 
-  constexpr bool
+  bool
   is_json_object () const noexcept
   {
-    return std::get_if<std::unordered_map<std::string, Json> > (&value)
+    return std::get_if<std::unordered_map<std::string, Json> > (&data ())
            != nullptr;
   }
 
-  constexpr bool
+  bool
   is_json_array () const noexcept
   {
-    return std::get_if<std::vector<Json> > (&value) != nullptr;
+    return std::get_if<std::vector<Json> > (&data ()) != nullptr
+           || std::get_if<json_number_array> (&data ()) != nullptr;
   }
 
-  constexpr bool
+  bool
   is_json_string () const noexcept
   {
-    return std::get_if<std::string> (&value) != nullptr;
+    return std::get_if<std::string> (&data ()) != nullptr;
   }
 
-  constexpr bool
+  bool
   is_json_number () const noexcept
   {
-    return std::get_if<double> (&value) != nullptr;
+    return std::get_if<double> (&data ()) != nullptr
+           || std::get_if<json_raw_number> (&data ()) != nullptr;
   }
 
-  constexpr bool
+  bool
   is_json_boolean () const noexcept
   {
-    return std::get_if<bool> (&value) != nullptr;
+    return std::get_if<bool> (&data ()) != nullptr;
   }
 
-  constexpr bool
+  bool
   is_json_null () const noexcept
   {
-    return std::get_if<std::nullptr_t> (&value) != nullptr;
+    return std::get_if<std::nullptr_t> (&data ()) != nullptr;
   }
 
   // accessor method Json::at(key)
@@ -673,30 +1072,87 @@ public:
   const T &
   as () const
   {
-    return std::get<T> (value);
+    return std::get<T> (data ());
   }
 
   template <typename T>
   T &
   as ()
   {
-    return std::get<T> (value);
+    return std::get<T> (mutable_data ());
   }
 
-  const std::unordered_map<std::string, Json>& get_json_value_as_unordered_map() const noexcept
+private:
+  struct serialized_json
   {
-    static const std::unordered_map<std::string, Json> value_as_json_object{{"", *this}};
-    return value_as_json_object;
+    int indent;
+    int level;
+    std::string text;
+  };
+
+  struct shared_node
+  {
+    explicit shared_node (JSONValue &&node_value)
+        : value{ std::move (node_value) }
+    {
+    }
+
+    JSONValue value;
+    // 0 until computed
+    mutable std::atomic<std::size_t> hash{};
+    mutable std::atomic<std::shared_ptr<const serialized_json> > serialized;
+  };
+
+  // Iteration range of non-object values. It is never modified, so handing it
+  // out to concurrent readers is safe.
+  static std::unordered_map<std::string, Json> &
+  empty_json_object () noexcept
+  {
+    static std::unordered_map<std::string, Json> empty_object;
+    return empty_object;
   }
 
-  std::unordered_map<std::string, Json>& get_json_value_as_unordered_map() noexcept
+  std::unordered_map<std::string, Json> &
+  object_members ()
   {
-    static std::unordered_map<std::string, Json> value_as_json_object{{"", *this}};
-    return value_as_json_object;
+    return is_json_object () ? get_json_value_as_object ()->get ()
+                             : empty_json_object ();
+  }
+
+  const std::unordered_map<std::string, Json> &
+  object_members () const
+  {
+    return is_json_object () ? get_json_value_as_object ()->get ()
+                             : empty_json_object ();
+  }
+
+  const JSONValue &
+  data () const noexcept
+  {
+    return shared_value ? shared_value->value : value;
+  }
+
+  JSONValue &
+  mutable_data ()
+  {
+    if (shared_value)
+      {
+        if (shared_value.use_count () == 1)
+          {
+            // use_count () is a relaxed load; the fence orders the reads of
+            // a thread that just dropped its reference before the move.
+            std::atomic_thread_fence (std::memory_order_acquire);
+            value = std::move (shared_value->value);
+          }
+        else
+          value = shared_value->value;
+        shared_value.reset ();
+      }
+    return value;
   }
 
-private:
   JSONValue value;
+  std::shared_ptr<shared_node> shared_value;
 };
 
 struct result_type
@@ -714,11 +1170,65 @@ struct result_type
 };
 
 inline result_type
-operator"" _json (const char *json_string, const size_t)
+operator"" _json (const char *json_string, const size_t length)
 {
-  return parse (json_string);
+  return parse (std::string_view{ json_string, length });
 }
 
+// Containers kept by a parser between calls: emptied arrays and objects
+// that still own their buffers and bucket arrays, detached object members
+// and long strings.
+struct json_node_pool
+{
+  std::vector<std::vector<Json> > arrays;
+  std::vector<std::vector<double> > number_arrays;
+  std::vector<std::unordered_map<std::string, Json> > objects;
+  std::vector<std::unordered_map<std::string, Json>::node_type> members;
+  std::vector<std::string> strings;
+};
+
+// Parser that reuses memory across calls. Handing a result that is no
+// longer needed back through recycle () puts its containers into a pool
+// the next parse () takes from, so parsing a steady stream of similarly
+// shaped messages barely touches the allocator. Not thread safe: keep one
+// parser per thread.
+class parser
+{
+public:
+  explicit parser (parse_options options = {}) noexcept
+      : options{ std::move (options) }
+  {
+  }
+
+  result_type parse (std::string_view input);
+
+  // Takes the containers of json for reuse. Shared subtrees are skipped,
+  // as their storage may still be referenced elsewhere.
+  void recycle (Json &&json);
+
+  // Releases the pooled memory.
+  void
+  clear_pool () noexcept
+  {
+    pool = json_node_pool{};
+  }
+
+  const json_node_pool &
+  pooled () const noexcept
+  {
+    return pool;
+  }
+
+  // Upper bound on the containers of each kind kept in the pool.
+  static constexpr size_t max_pooled_containers{ 1 << 16 };
+
+private:
+  void harvest (Json &json);
+
+  parse_options options;
+  json_node_pool pool;
+};
+
 inline Json::iterator
 begin (Json &json)
 {
@@ -757,4 +1267,13 @@ cend (const Json &json)
 
 } // namespace simple_json
 
+template <> struct std::hash<simple_json::Json>
+{
+  std::size_t
+  operator() (const simple_json::Json &json) const
+  {
+    return json.hash ();
+  }
+};
+
 #endif // SIMPLE_JSON_H
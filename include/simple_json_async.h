@@ -0,0 +1,256 @@
+#ifndef SIMPLE_JSON_ASYNC_H
+#define SIMPLE_JSON_ASYNC_H
+
+#include "simple_json.h"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace simple_json
+{
+
+enum class json_stream_mode
+{
+  values,        // a sequence of top-level values (NDJSON, concatenated JSON)
+  array_elements // the elements of one top-level array
+};
+
+// Resumable boundary scanner: input is fed in arbitrary chunks and every
+// value is handed to parseValue () as soon as its last byte has arrived.
+// Only the bytes of the value being scanned are buffered, and scanning
+// resumes where the previous chunk ended. Syntax errors throw
+// std::invalid_argument.
+class json_stream_splitter
+{
+public:
+  explicit json_stream_splitter (
+      json_stream_mode mode = json_stream_mode::values) noexcept
+      : mode{ mode }
+  {
+  }
+
+  void feed (std::string_view chunk);
+
+  // Marks the end of the input; a value still open then is an error.
+  void
+  finish () noexcept
+  {
+    is_finished = true;
+  }
+
+  // Returns the next complete value, or std::nullopt if more input is
+  // needed (or, after finish (), none is left).
+  std::optional<Json> next ();
+
+  bool
+  is_done () const noexcept
+  {
+    return is_finished && is_drained;
+  }
+
+private:
+  enum class array_state
+  {
+    before_open,
+    expect_first_element,
+    expect_element,
+    expect_separator,
+    closed
+  };
+
+  bool scan_value ();
+  Json parse_value (size_t end);
+
+  json_stream_mode mode;
+  std::string buffer;
+  size_t scan_pos{};
+  size_t value_start{ std::string::npos };
+  size_t depth{};
+  bool is_in_string{};
+  bool is_finished{};
+  bool is_drained{};
+  array_state state{ array_state::before_open };
+};
+
+// Values produced by parse_async (). The producing coroutine only runs
+// while a consumer awaits next (), and suspends whenever it waits for
+// input, so nothing blocks the consumer's thread.
+class json_value_stream
+{
+public:
+  struct promise_type
+  {
+    std::optional<Json> current;
+    std::exception_ptr error;
+    std::coroutine_handle<> consumer;
+
+    struct resume_consumer
+    {
+      bool
+      await_ready () const noexcept
+      {
+        return false;
+      }
+
+      std::coroutine_handle<>
+      await_suspend (std::coroutine_handle<promise_type> handle) noexcept
+      {
+        return handle.promise ().consumer;
+      }
+
+      void
+      await_resume () const noexcept
+      {
+      }
+    };
+
+    json_value_stream
+    get_return_object () noexcept
+    {
+      return json_value_stream{
+        std::coroutine_handle<promise_type>::from_promise (*this)
+      };
+    }
+
+    std::suspend_always
+    initial_suspend () const noexcept
+    {
+      return {};
+    }
+
+    resume_consumer
+    final_suspend () const noexcept
+    {
+      return {};
+    }
+
+    resume_consumer
+    yield_value (Json &&json) noexcept
+    {
+      current.emplace (std::move (json));
+      return {};
+    }
+
+    void
+    return_void () const noexcept
+    {
+    }
+
+    void
+    unhandled_exception () noexcept
+    {
+      error = std::current_exception ();
+    }
+  };
+
+  class next_awaiter
+  {
+  public:
+    explicit next_awaiter (std::coroutine_handle<promise_type> producer)
+        : producer{ producer }
+    {
+    }
+
+    bool
+    await_ready () const noexcept
+    {
+      return !producer || producer.done ();
+    }
+
+    std::coroutine_handle<>
+    await_suspend (std::coroutine_handle<> consumer) noexcept
+    {
+      producer.promise ().consumer = consumer;
+      producer.promise ().current.reset ();
+      return producer;
+    }
+
+    // std::nullopt once the input is exhausted; rethrows parse errors and
+    // errors of the chunk source.
+    std::optional<Json>
+    await_resume ()
+    {
+      if (!producer)
+        return std::nullopt;
+      promise_type &promise{ producer.promise () };
+      if (promise.error)
+        std::rethrow_exception (std::exchange (promise.error, nullptr));
+      if (producer.done ())
+        return std::nullopt;
+      return std::move (promise.current);
+    }
+
+  private:
+    std::coroutine_handle<promise_type> producer;
+  };
+
+  json_value_stream (json_value_stream &&other) noexcept
+      : producer{ std::exchange (other.producer, nullptr) }
+  {
+  }
+
+  json_value_stream &
+  operator= (json_value_stream &&other) noexcept
+  {
+    if (this != &other)
+      {
+        if (producer)
+          producer.destroy ();
+        producer = std::exchange (other.producer, nullptr);
+      }
+    return *this;
+  }
+
+  ~json_value_stream ()
+  {
+    if (producer)
+      producer.destroy ();
+  }
+
+  // Must not be awaited again before the previous next () completed.
+  next_awaiter
+  next () noexcept
+  {
+    return next_awaiter{ producer };
+  }
+
+private:
+  explicit json_value_stream (
+      std::coroutine_handle<promise_type> producer) noexcept
+      : producer{ producer }
+  {
+  }
+
+  std::coroutine_handle<promise_type> producer;
+};
+
+// Parses the chunks produced by co_await source () and yields each value as
+// it completes. source is called with no arguments and returns an awaitable
+// resulting in an optional string-like chunk, std::nullopt marking the end
+// of input. The chunk is copied before source is awaited again.
+template <typename Source>
+json_value_stream
+parse_async (Source source,
+             const json_stream_mode mode = json_stream_mode::values)
+{
+  json_stream_splitter splitter{ mode };
+  while (!splitter.is_done ())
+    {
+      while (std::optional<Json> json = splitter.next ())
+        co_yield std::move (*json);
+      if (splitter.is_done ())
+        break;
+      if (auto chunk = co_await source ())
+        splitter.feed (std::string_view{ *chunk });
+      else
+        splitter.finish ();
+    }
+}
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_ASYNC_H
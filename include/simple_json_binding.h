@@ -0,0 +1,291 @@
+#ifndef SIMPLE_JSON_BINDING_H
+#define SIMPLE_JSON_BINDING_H
+
+#include "simple_json.h"
+
+#include <charconv>
+#include <concepts>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Maps the listed data members of Struct to JSON object keys of the same
+// name. Must be used in the namespace that declares Struct, e.g.
+//   struct point { double x; double y; };
+//   SIMPLE_JSON_FIELDS (point, x, y)
+#define SIMPLE_JSON_FIELDS(Struct, ...)                                       \
+  [[maybe_unused]] constexpr auto simple_json_members (const Struct *)        \
+      noexcept                                                                \
+  {                                                                           \
+    return std::make_tuple (                                                  \
+        SIMPLE_JSON_FOR_EACH (SIMPLE_JSON_MEMBER, Struct, __VA_ARGS__));      \
+  }
+
+#define SIMPLE_JSON_MEMBER(Struct, member)                                    \
+  simple_json::json_member<Struct, decltype (Struct::member)>                 \
+  {                                                                           \
+    #member, &Struct::member                                                  \
+  }
+
+#define SIMPLE_JSON_PARENS ()
+#define SIMPLE_JSON_EXPAND(...)                                               \
+  SIMPLE_JSON_EXPAND3 (SIMPLE_JSON_EXPAND3 (                                  \
+      SIMPLE_JSON_EXPAND3 (SIMPLE_JSON_EXPAND3 (__VA_ARGS__))))
+#define SIMPLE_JSON_EXPAND3(...)                                              \
+  SIMPLE_JSON_EXPAND2 (SIMPLE_JSON_EXPAND2 (                                  \
+      SIMPLE_JSON_EXPAND2 (SIMPLE_JSON_EXPAND2 (__VA_ARGS__))))
+#define SIMPLE_JSON_EXPAND2(...)                                              \
+  SIMPLE_JSON_EXPAND1 (SIMPLE_JSON_EXPAND1 (                                  \
+      SIMPLE_JSON_EXPAND1 (SIMPLE_JSON_EXPAND1 (__VA_ARGS__))))
+#define SIMPLE_JSON_EXPAND1(...) __VA_ARGS__
+#define SIMPLE_JSON_FOR_EACH(macro, Struct, ...)                              \
+  __VA_OPT__ (SIMPLE_JSON_EXPAND (                                            \
+      SIMPLE_JSON_FOR_EACH_HELPER (macro, Struct, __VA_ARGS__)))
+#define SIMPLE_JSON_FOR_EACH_HELPER(macro, Struct, first, ...)                \
+  macro (Struct, first) __VA_OPT__ (, SIMPLE_JSON_FOR_EACH_AGAIN              \
+                                          SIMPLE_JSON_PARENS (                \
+                                              macro, Struct, __VA_ARGS__))
+#define SIMPLE_JSON_FOR_EACH_AGAIN() SIMPLE_JSON_FOR_EACH_HELPER
+
+namespace simple_json
+{
+
+template <typename Class, typename Member> struct json_member
+{
+  std::string_view name;
+  Member Class::*pointer;
+};
+
+template <typename T>
+concept json_mapped = requires (const T *ptr) { simple_json_members (ptr); };
+
+template <typename T> struct is_std_vector : std::false_type
+{
+};
+
+template <typename T, typename Alloc>
+struct is_std_vector<std::vector<T, Alloc> > : std::true_type
+{
+};
+
+template <typename T> struct is_std_optional : std::false_type
+{
+};
+
+template <typename T>
+struct is_std_optional<std::optional<T> > : std::true_type
+{
+};
+
+// Pull parser over JSON text used by the binding layer: values are read
+// straight into their destination without building a Json tree.
+class json_reader
+{
+public:
+  explicit json_reader (std::string_view input) noexcept : input{ input } {}
+
+  void skip_whitespace () noexcept;
+  char peek ();
+  bool consume (char ch);
+  void expect (char ch);
+
+  // Returns a view of the key; escaped keys are decoded into scratch.
+  std::string_view read_key (std::string &scratch);
+  void read_string (std::string &out);
+
+  // The characters up to the next '"', escapes kept, as parse () reads
+  // strings and keys.
+  std::string_view read_raw_string ();
+  bool read_boolean ();
+  bool consume_null ();
+  std::string_view read_number_text ();
+  std::string_view read_raw_value ();
+  void skip_value ();
+  void expect_end ();
+
+  [[noreturn]] void fail (const char *message) const;
+
+private:
+  void skip_string ();
+
+  std::string_view input;
+  size_t pos{};
+};
+
+void write_json_string (std::string &out, std::string_view str);
+void write_json_number (std::string &out, double number);
+
+// Compact JSON text of json. Strings and keys hold the text parse () read,
+// escapes included, so they are written back as is rather than escaped
+// again.
+void write_json (std::string &out, const Json &json);
+
+template <typename T>
+void
+read_json_value (json_reader &reader, T &out)
+{
+  if constexpr (std::is_same_v<T, bool>)
+    out = reader.read_boolean ();
+  else if constexpr (std::is_arithmetic_v<T>)
+    {
+      const std::string_view text{ reader.read_number_text () };
+      const auto [ptr, ec]
+          = std::from_chars (text.data (), text.data () + text.size (), out);
+      if (ec != std::errc{} || ptr != text.data () + text.size ())
+        reader.fail ("Invalid JSON number for the bound member type!");
+    }
+  else if constexpr (std::is_same_v<T, std::string>)
+    reader.read_string (out);
+  else if constexpr (std::is_same_v<T, Json>)
+    {
+      auto [json_value, json_status, error_msg]
+          = parse (reader.read_raw_value ());
+      if (json_status != status::success || !json_value.has_value ())
+        reader.fail ("Invalid embedded JSON value!");
+      out = std::move (json_value.value ());
+    }
+  else if constexpr (is_std_optional<T>::value)
+    {
+      if (reader.consume_null ())
+        out.reset ();
+      else
+        read_json_value (reader, out.emplace ());
+    }
+  else if constexpr (is_std_vector<T>::value)
+    {
+      out.clear ();
+      reader.expect ('[');
+      if (reader.consume (']'))
+        return;
+      do
+        read_json_value (reader, out.emplace_back ());
+      while (reader.consume (','));
+      reader.expect (']');
+    }
+  else if constexpr (json_mapped<T>)
+    {
+      static constexpr auto members{ simple_json_members (
+          static_cast<const T *> (nullptr)) };
+      reader.expect ('{');
+      if (reader.consume ('}'))
+        return;
+      std::string scratch;
+      do
+        {
+          const std::string_view key{ reader.read_key (scratch) };
+          reader.expect (':');
+          const bool is_bound_key = std::apply (
+              [&] (const auto &...member) {
+                return ((key == member.name
+                             ? (read_json_value (reader, out.*member.pointer),
+                                true)
+                             : false)
+                        || ...);
+              },
+              members);
+          if (!is_bound_key)
+            reader.skip_value ();
+        }
+      while (reader.consume (','));
+      reader.expect ('}');
+    }
+  else
+    static_assert (json_mapped<T>,
+                   "type is not bindable, use SIMPLE_JSON_FIELDS");
+}
+
+template <typename T>
+void
+write_json_value (std::string &out, const T &value)
+{
+  if constexpr (std::is_same_v<T, bool>)
+    out += value ? "true" : "false";
+  else if constexpr (std::is_integral_v<T>)
+    {
+      char buffer[32];
+      const auto [ptr, ec] = std::to_chars (buffer, buffer + sizeof buffer,
+                                            value);
+      out.append (buffer, ptr);
+    }
+  else if constexpr (std::is_floating_point_v<T>)
+    write_json_number (out, static_cast<double> (value));
+  else if constexpr (std::is_same_v<T, std::string>)
+    write_json_string (out, value);
+  else if constexpr (std::is_same_v<T, Json>)
+    write_json (out, value);
+  else if constexpr (is_std_optional<T>::value)
+    {
+      if (value.has_value ())
+        write_json_value (out, value.value ());
+      else
+        out += "null";
+    }
+  else if constexpr (is_std_vector<T>::value)
+    {
+      out += '[';
+      for (size_t i{}; i < value.size (); ++i)
+        {
+          if (i != 0)
+            out += ',';
+          write_json_value (out, value[i]);
+        }
+      out += ']';
+    }
+  else if constexpr (json_mapped<T>)
+    {
+      static constexpr auto members{ simple_json_members (
+          static_cast<const T *> (nullptr)) };
+      out += '{';
+      bool is_first{ true };
+      std::apply (
+          [&] (const auto &...member) {
+            ((out += is_first ? "\"" : ",\"", is_first = false,
+              out += member.name, out += "\":",
+              write_json_value (out, value.*member.pointer)),
+             ...);
+          },
+          members);
+      out += '}';
+    }
+  else
+    static_assert (json_mapped<T>,
+                   "type is not bindable, use SIMPLE_JSON_FIELDS");
+}
+
+// Parses input directly into out, throws std::invalid_argument on error.
+template <typename T>
+void
+parse_into (const std::string_view input, T &out)
+{
+  json_reader reader{ input };
+  read_json_value (reader, out);
+  reader.expect_end ();
+}
+
+template <typename T>
+T
+parse_as (const std::string_view input)
+{
+  // T () rather than T{}: aggregate initialization from {} would
+  // copy-list-initialize members and reject Json's explicit constructor
+  T result = T ();
+  parse_into (input, result);
+  return result;
+}
+
+template <typename T>
+std::string
+to_json_string (const T &value)
+{
+  std::string out;
+  write_json_value (out, value);
+  return out;
+}
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_BINDING_H
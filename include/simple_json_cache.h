@@ -0,0 +1,89 @@
+#ifndef SIMPLE_JSON_CACHE_H
+#define SIMPLE_JSON_CACHE_H
+
+#include "simple_json.h"
+#include "simple_json_snapshot.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+
+// 64 bit hash of the raw input bytes (the XXH64 algorithm).
+std::uint64_t hash_json_input (std::string_view input) noexcept;
+
+// Content addressed cache in front of parse (). Byte identical inputs share
+// one immutable parsed document. Memory is bounded by capacity_bytes, which
+// covers the retained input bytes plus an estimate of the parsed tree; the
+// least recently used entries are evicted with the CLOCK algorithm.
+// All member functions are thread safe; parsing runs outside the lock.
+class json_parse_cache
+{
+public:
+  explicit json_parse_cache (size_t capacity_bytes);
+
+  json_parse_cache (const json_parse_cache &) = delete;
+  json_parse_cache &operator= (const json_parse_cache &) = delete;
+
+  // Returns the cached document for input, parsing and caching it on a
+  // miss. Invalid input throws std::invalid_argument and is not cached.
+  frozen_json parse (std::string_view input);
+
+  void clear ();
+
+  std::uint64_t
+  hits () const noexcept
+  {
+    return hit_count.load (std::memory_order_relaxed);
+  }
+
+  std::uint64_t
+  misses () const noexcept
+  {
+    return miss_count.load (std::memory_order_relaxed);
+  }
+
+  size_t
+  capacity () const noexcept
+  {
+    return capacity_bytes;
+  }
+
+  size_t size_bytes () const;
+  size_t entry_count () const;
+
+private:
+  struct entry
+  {
+    std::string input;
+    std::uint64_t hash{};
+    frozen_json document;
+    size_t charge{};
+    bool is_referenced{};
+    bool is_occupied{};
+  };
+
+  void insert (std::uint64_t hash, std::string_view input,
+               const frozen_json &document, size_t charge);
+  void evict (size_t slot);
+
+  const size_t capacity_bytes;
+  mutable std::mutex mutex;
+  std::vector<entry> entries;
+  std::vector<size_t> free_slots;
+  std::unordered_map<std::uint64_t, size_t> slot_by_hash;
+  size_t clock_hand{};
+  size_t used_bytes{};
+  std::atomic<std::uint64_t> hit_count{};
+  std::atomic<std::uint64_t> miss_count{};
+};
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_CACHE_H
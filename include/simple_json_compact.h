@@ -0,0 +1,262 @@
+#ifndef SIMPLE_JSON_COMPACT_H
+#define SIMPLE_JSON_COMPACT_H
+
+#include "simple_json.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace simple_json
+{
+
+struct compact_member;
+
+// 16 byte read-only JSON node: a one byte tag plus either an inline payload
+// (bool, number, strings of up to max_short_string bytes) or a pointer and
+// a size into the arena of the owning compact_document. Nodes are only
+// valid while a copy of that document is alive. Numbers are stored as
+// double, so raw number text (parse_options::lazy_numbers) is decoded.
+class compact_json
+{
+public:
+  static constexpr size_t max_short_string{ 14 };
+
+  compact_json () noexcept : storage{ .node{} } {}
+
+  json_type get_json_element_type () const noexcept;
+
+  bool
+  is_json_object () const noexcept
+  {
+    return tag () == kind::object;
+  }
+
+  bool
+  is_json_array () const noexcept
+  {
+    return tag () == kind::array;
+  }
+
+  bool
+  is_json_string () const noexcept
+  {
+    return tag () == kind::short_string || tag () == kind::string;
+  }
+
+  bool
+  is_json_number () const noexcept
+  {
+    return tag () == kind::number;
+  }
+
+  bool
+  is_json_boolean () const noexcept
+  {
+    return tag () == kind::boolean;
+  }
+
+  bool
+  is_json_null () const noexcept
+  {
+    return tag () == kind::null;
+  }
+
+  double to_number () const noexcept;
+
+  bool
+  to_bool () const noexcept
+  {
+    return is_json_boolean () && storage.node.boolean;
+  }
+
+  std::optional<bool> get_json_value_as_bool () const noexcept;
+  std::optional<double> get_json_value_as_number () const noexcept;
+
+  // Short strings are stored inside the node, so the view refers to *this.
+  std::optional<std::string_view> get_json_value_as_string () const noexcept;
+
+  std::optional<std::span<const compact_json> >
+  get_json_value_as_array () const noexcept;
+
+  // Members are sorted by key length, then by key.
+  std::optional<std::span<const compact_member> >
+  get_json_value_as_object () const noexcept;
+
+  // Number of elements, members or string bytes; 0 for scalars.
+  size_t size () const noexcept;
+
+  // Binary search over the members; nullptr if absent or not an object.
+  const compact_json *find (std::string_view key) const noexcept;
+
+  // Throws std::invalid_argument for non-objects and std::out_of_range for
+  // missing keys, like Json::get_json_element_if_exists ().
+  const compact_json &get_json_element_if_exists (std::string_view key) const;
+
+  // Returns a null node for non-objects and missing keys.
+  const compact_json &get_json_element (std::string_view key) const noexcept;
+
+  const compact_json &
+  at (std::string_view key) const
+  {
+    return get_json_element_if_exists (key);
+  }
+
+  const compact_json &
+  operator[] (std::string_view key) const noexcept
+  {
+    return get_json_element (key);
+  }
+
+  // Deep copy into a regular Json tree.
+  Json to_json () const;
+
+  std::string
+  to_string (int indent = 0) const
+  {
+    return to_json ().to_string (indent);
+  }
+
+private:
+  friend class compact_document;
+
+  enum class kind : std::uint8_t
+  {
+    null,
+    boolean,
+    number,
+    short_string,
+    string,
+    array,
+    object
+  };
+
+  // Both layouts start with the tag, which may therefore be read through
+  // either of them.
+  struct short_string_layout
+  {
+    kind tag;
+    std::uint8_t length;
+    char chars[max_short_string];
+  };
+
+  struct node_layout
+  {
+    kind tag;
+    bool boolean;
+    std::uint32_t size;
+    union
+    {
+      double number;
+      const char *chars;
+      const compact_json *elements;
+      const compact_member *members;
+    };
+  };
+
+  union layout
+  {
+    short_string_layout short_string;
+    node_layout node;
+  };
+
+  kind
+  tag () const noexcept
+  {
+    return storage.node.tag;
+  }
+
+  // The string of a node known to be a string (an object key).
+  std::string_view
+  key_view () const noexcept
+  {
+    if (tag () == kind::short_string)
+      return { storage.short_string.chars, storage.short_string.length };
+    return { storage.node.chars, storage.node.size };
+  }
+
+  layout storage;
+};
+
+static_assert (sizeof (compact_json) == 16);
+
+struct compact_member
+{
+  compact_json key;
+  compact_json value;
+};
+
+// Immutable document of compact_json nodes. All nodes and long strings are
+// bump-allocated from one arena owned by the document, so a tree takes a
+// fraction of the memory of the equivalent Json and children are laid out
+// next to each other. Copies are O(1) and share the arena.
+class compact_document
+{
+public:
+  compact_document ();
+
+  // Throws std::invalid_argument for strings, arrays or objects with more
+  // than 2^32 - 1 bytes, elements or members.
+  explicit compact_document (const Json &json);
+
+  const compact_json &
+  root () const noexcept
+  {
+    return *root_node;
+  }
+
+  const compact_json &
+  operator* () const noexcept
+  {
+    return *root_node;
+  }
+
+  const compact_json *
+  operator->() const noexcept
+  {
+    return root_node;
+  }
+
+  const compact_json &
+  at (std::string_view key) const
+  {
+    return root_node->at (key);
+  }
+
+  const compact_json &
+  operator[] (std::string_view key) const noexcept
+  {
+    return (*root_node)[key];
+  }
+
+  // Bytes requested from the arena for nodes and long strings.
+  size_t allocated_bytes () const noexcept;
+
+  Json
+  to_json () const
+  {
+    return root_node->to_json ();
+  }
+
+  std::string
+  to_string (int indent = 0) const
+  {
+    return root_node->to_string (indent);
+  }
+
+private:
+  struct arena;
+
+  std::shared_ptr<const arena> nodes;
+  const compact_json *root_node;
+};
+
+const compact_json *find_json_pointer (const compact_json &json,
+                                       std::string_view pointer);
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_COMPACT_H
@@ -0,0 +1,93 @@
+#ifndef SIMPLE_JSON_INDEX_H
+#define SIMPLE_JSON_INDEX_H
+
+#include "simple_json.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+
+// Unique hash index over the elements of a JSON array, keyed by the string
+// or number found at a JSON pointer inside each element (e.g. "/sku").
+// Elements where the pointer resolves to nothing or to another type are
+// kept in the array but not indexed. The index refers to the array, which
+// must outlive it and should only be modified through push_back () and
+// erase () while indexed; otherwise call rebuild ().
+class json_index
+{
+public:
+  // Throws std::invalid_argument if array is not an array or two elements
+  // share a key.
+  json_index (Json &array, std::string_view pointer);
+
+  Json *find (std::string_view key);
+  Json *find (double key);
+  const Json *find (std::string_view key) const;
+  const Json *find (double key) const;
+
+  std::optional<size_t> position (std::string_view key) const noexcept;
+  std::optional<size_t> position (double key) const noexcept;
+
+  // Appends element to the array and indexes it. Throws
+  // std::invalid_argument, leaving the array unchanged, if its key is
+  // already indexed.
+  void push_back (Json element);
+
+  // Swap-remove: the last element moves into position, so removal is O(1)
+  // but does not keep the order of the array.
+  void erase_at (size_t position);
+
+  // Removes the element with key; false if there is none.
+  bool erase (std::string_view key);
+  bool erase (double key);
+
+  // Re-indexes the whole array after it was modified directly.
+  void rebuild ();
+
+  // Number of indexed elements.
+  size_t
+  size () const noexcept
+  {
+    return strings.size () + numbers.size ();
+  }
+
+private:
+  struct string_hash
+  {
+    using is_transparent = void;
+
+    std::size_t
+    operator() (std::string_view str) const noexcept
+    {
+      return std::hash<std::string_view>{}(str);
+    }
+  };
+
+  const Json *key_of (const Json &element) const;
+  void insert (const Json &element, size_t position);
+  void remove (const Json &element);
+  std::vector<Json> &elements ();
+  const std::vector<Json> &elements () const;
+
+  Json *array;
+  std::vector<std::string> tokens; // the pointer, split once
+  std::unordered_map<std::string, size_t, string_hash, std::equal_to<> >
+      strings;
+  std::unordered_map<double, size_t> numbers; // NaN keys are not indexed
+};
+
+inline json_index
+build_index (Json &array, const std::string_view pointer)
+{
+  return json_index{ array, pointer };
+}
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_INDEX_H
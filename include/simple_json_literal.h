@@ -0,0 +1,496 @@
+#ifndef SIMPLE_JSON_LITERAL_H
+#define SIMPLE_JSON_LITERAL_H
+
+#include "simple_json.h"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+
+enum class json_token_kind : unsigned char
+{
+  null_t,
+  true_t,
+  false_t,
+  number_t,
+  string_t,
+  array_t,
+  object_t
+};
+
+// One entry of a pre-tokenized JSON literal in document order. Containers
+// store their number of children (members for objects, each member being
+// a string key token followed by its value tokens).
+struct json_literal_token
+{
+  json_token_kind kind{};
+  bool has_exact_number{};
+  unsigned offset{};
+  unsigned length{};
+  double number{};
+};
+
+// Strict RFC 8259 recursive descent scanner usable in constant expressions.
+// Sink receives the tokens: push() returns the token's index and
+// set_count() patches a container's child count once it is known.
+template <typename Sink> class json_literal_scanner
+{
+public:
+  constexpr json_literal_scanner (std::string_view text, Sink &sink) noexcept
+      : text{ text }, sink{ sink }
+  {
+  }
+
+  constexpr bool
+  scan ()
+  {
+    skip_whitespace ();
+    if (!scan_value ())
+      return false;
+    skip_whitespace ();
+    return pos == text.size ();
+  }
+
+private:
+  constexpr void
+  skip_whitespace () noexcept
+  {
+    while (pos < text.size ()
+           && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n'
+               || text[pos] == '\r'))
+      ++pos;
+  }
+
+  constexpr bool
+  consume (const char ch) noexcept
+  {
+    skip_whitespace ();
+    if (pos < text.size () && text[pos] == ch)
+      {
+        ++pos;
+        return true;
+      }
+    return false;
+  }
+
+  constexpr bool
+  scan_literal (const std::string_view literal, const json_token_kind kind)
+  {
+    if (text.substr (pos, literal.size ()) != literal)
+      return false;
+    sink.push (json_literal_token{ kind, false, static_cast<unsigned> (pos),
+                                   static_cast<unsigned> (literal.size ()) });
+    pos += literal.size ();
+    return true;
+  }
+
+  constexpr bool
+  scan_value ()
+  {
+    if (pos >= text.size ())
+      return false;
+    switch (text[pos])
+      {
+      case '{':
+        return scan_object ();
+      case '[':
+        return scan_array ();
+      case '"':
+        return scan_string ();
+      case 't':
+        return scan_literal ("true", json_token_kind::true_t);
+      case 'f':
+        return scan_literal ("false", json_token_kind::false_t);
+      case 'n':
+        return scan_literal ("null", json_token_kind::null_t);
+      default:
+        return scan_number ();
+      }
+  }
+
+  constexpr bool
+  scan_object ()
+  {
+    const size_t index{ sink.push (json_literal_token{
+        json_token_kind::object_t, false, static_cast<unsigned> (pos) }) };
+    ++pos;
+    unsigned count{};
+    if (!consume ('}'))
+      {
+        do
+          {
+            skip_whitespace ();
+            if (pos >= text.size () || text[pos] != '"' || !scan_string ()
+                || !consume (':'))
+              return false;
+            skip_whitespace ();
+            if (!scan_value ())
+              return false;
+            ++count;
+          }
+        while (consume (','));
+        if (!consume ('}'))
+          return false;
+      }
+    sink.set_count (index, count);
+    return true;
+  }
+
+  constexpr bool
+  scan_array ()
+  {
+    const size_t index{ sink.push (json_literal_token{
+        json_token_kind::array_t, false, static_cast<unsigned> (pos) }) };
+    ++pos;
+    unsigned count{};
+    if (!consume (']'))
+      {
+        do
+          {
+            skip_whitespace ();
+            if (!scan_value ())
+              return false;
+            ++count;
+          }
+        while (consume (','));
+        if (!consume (']'))
+          return false;
+      }
+    sink.set_count (index, count);
+    return true;
+  }
+
+  static constexpr bool
+  is_hex_digit (const char ch) noexcept
+  {
+    return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f')
+           || (ch >= 'A' && ch <= 'F');
+  }
+
+  constexpr bool
+  scan_string ()
+  {
+    const size_t start{ ++pos };
+    while (pos < text.size () && text[pos] != '"')
+      {
+        if (static_cast<unsigned char> (text[pos]) < 0x20)
+          return false;
+        if (text[pos] == '\\')
+          {
+            if (++pos >= text.size ())
+              return false;
+            if (text[pos] == 'u')
+              {
+                for (size_t i{ 1 }; i <= 4; ++i)
+                  if (pos + i >= text.size () || !is_hex_digit (text[pos + i]))
+                    return false;
+                pos += 4;
+              }
+            else if (std::string_view{ "\"\\/bfnrt" }.find (text[pos])
+                     == std::string_view::npos)
+              return false;
+          }
+        ++pos;
+      }
+    if (pos >= text.size ())
+      return false;
+    sink.push (json_literal_token{ json_token_kind::string_t, false,
+                                   static_cast<unsigned> (start),
+                                   static_cast<unsigned> (pos - start) });
+    ++pos;
+    return true;
+  }
+
+  constexpr bool
+  is_digit_at (const size_t index) const noexcept
+  {
+    return index < text.size () && text[index] >= '0' && text[index] <= '9';
+  }
+
+  // Numbers whose mantissa fits in 53 bits and whose decimal exponent is
+  // within +-22 are converted exactly here (one correctly rounded IEEE
+  // multiplication or division), the rest are converted at runtime.
+  constexpr bool
+  scan_number ()
+  {
+    const size_t start{ pos };
+    const bool is_negative{ text[pos] == '-' };
+    if (is_negative)
+      ++pos;
+    if (!is_digit_at (pos))
+      return false;
+
+    std::uint64_t mantissa{};
+    int significant_digits{};
+    int exponent{};
+    bool is_truncated{};
+    const auto accumulate_digit = [&] (const char digit,
+                                       const bool is_fraction) {
+      if (significant_digits == 0 && digit == '0')
+        {
+          if (is_fraction)
+            --exponent;
+          return;
+        }
+      if (significant_digits < 19)
+        {
+          mantissa = mantissa * 10 + static_cast<unsigned> (digit - '0');
+          if (is_fraction)
+            --exponent;
+        }
+      else
+        {
+          is_truncated = true;
+          if (!is_fraction)
+            ++exponent;
+        }
+      ++significant_digits;
+    };
+
+    if (text[pos] == '0')
+      ++pos;
+    else
+      while (is_digit_at (pos))
+        accumulate_digit (text[pos++], false);
+
+    if (pos < text.size () && text[pos] == '.')
+      {
+        if (!is_digit_at (++pos))
+          return false;
+        while (is_digit_at (pos))
+          accumulate_digit (text[pos++], true);
+      }
+
+    if (pos < text.size () && (text[pos] == 'e' || text[pos] == 'E'))
+      {
+        ++pos;
+        bool is_negative_exponent{};
+        if (pos < text.size () && (text[pos] == '+' || text[pos] == '-'))
+          is_negative_exponent = text[pos++] == '-';
+        if (!is_digit_at (pos))
+          return false;
+        int explicit_exponent{};
+        while (is_digit_at (pos))
+          {
+            if (explicit_exponent < 100000)
+              explicit_exponent = explicit_exponent * 10 + (text[pos] - '0');
+            ++pos;
+          }
+        exponent += is_negative_exponent ? -explicit_exponent
+                                         : explicit_exponent;
+      }
+
+    json_literal_token token{ json_token_kind::number_t, false,
+                              static_cast<unsigned> (start),
+                              static_cast<unsigned> (pos - start) };
+    if (!is_truncated && mantissa <= (std::uint64_t{ 1 } << 53)
+        && exponent >= -22
+        && exponent <= 22)
+      {
+        double power_of_ten{ 1.0 };
+        for (int i{}; i < (exponent < 0 ? -exponent : exponent); ++i)
+          power_of_ten *= 10.0;
+        token.number = exponent < 0
+                           ? static_cast<double> (mantissa) / power_of_ten
+                           : static_cast<double> (mantissa) * power_of_ten;
+        if (is_negative)
+          token.number = -token.number;
+        token.has_exact_number = true;
+      }
+    sink.push (token);
+    return true;
+  }
+
+  std::string_view text;
+  Sink &sink;
+  size_t pos{};
+};
+
+struct json_token_counter
+{
+  size_t count{};
+
+  constexpr size_t
+  push (const json_literal_token &) noexcept
+  {
+    return count++;
+  }
+
+  constexpr void
+  set_count (size_t, unsigned) noexcept
+  {
+  }
+};
+
+template <size_t N> struct json_token_array
+{
+  std::array<json_literal_token, N> tokens{};
+  size_t count{};
+
+  constexpr size_t
+  push (const json_literal_token &token) noexcept
+  {
+    tokens[count] = token;
+    return count++;
+  }
+
+  constexpr void
+  set_count (const size_t index, const unsigned children) noexcept
+  {
+    tokens[index].length = children;
+  }
+};
+
+constexpr bool
+is_valid_json (const std::string_view text)
+{
+  json_token_counter counter;
+  return json_literal_scanner{ text, counter }.scan ();
+}
+
+// Intentionally not constexpr: reaching it during constant evaluation turns
+// a malformed JSON literal into a compile-time error.
+inline void
+malformed_json_literal ()
+{
+}
+
+template <size_t N> struct json_literal
+{
+  char text[N]{};
+
+  consteval json_literal (const char (&str)[N])
+  {
+    for (size_t i{}; i < N; ++i)
+      text[i] = str[i];
+    if (!is_valid_json (view ()))
+      malformed_json_literal ();
+  }
+
+  constexpr std::string_view
+  view () const noexcept
+  {
+    return { text, N - 1 };
+  }
+};
+
+// A JSON document validated and tokenized at compile time. Building the
+// Json value at runtime only walks the token array, it never re-scans text.
+template <json_literal Literal> class compiled_json
+{
+  static constexpr size_t token_count = [] {
+    json_token_counter counter;
+    json_literal_scanner{ Literal.view (), counter }.scan ();
+    return counter.count;
+  }();
+
+  static constexpr std::array<json_literal_token, token_count> tokens = [] {
+    json_token_array<token_count> sink;
+    json_literal_scanner{ Literal.view (), sink }.scan ();
+    return sink.tokens;
+  }();
+
+  static Json
+  build (size_t &index)
+  {
+    const json_literal_token &token{ tokens[index++] };
+    const std::string_view token_text{ Literal.view ().substr (
+        token.offset, token.length) };
+    switch (token.kind)
+      {
+      case json_token_kind::true_t:
+        return Json{ true };
+      case json_token_kind::false_t:
+        return Json{ false };
+      case json_token_kind::number_t:
+        {
+          if (token.has_exact_number)
+            return Json{ token.number };
+          double number{};
+          std::from_chars (token_text.data (),
+                           token_text.data () + token_text.size (), number);
+          return Json{ number };
+        }
+      case json_token_kind::string_t:
+        return Json{ std::string{ token_text } };
+      case json_token_kind::array_t:
+        {
+          std::vector<Json> elements;
+          elements.reserve (token.length);
+          for (unsigned i{}; i < token.length; ++i)
+            elements.push_back (build (index));
+          return Json{ std::move (elements) };
+        }
+      case json_token_kind::object_t:
+        {
+          std::unordered_map<std::string, Json> members;
+          members.reserve (token.length);
+          for (unsigned i{}; i < token.length; ++i)
+            {
+              const json_literal_token &key{ tokens[index++] };
+              std::string key_text{ Literal.view ().substr (key.offset,
+                                                            key.length) };
+              members.insert_or_assign (std::move (key_text), build (index));
+            }
+          return Json{ std::move (members) };
+        }
+      default:
+        return Json{ nullptr };
+      }
+  }
+
+public:
+  static constexpr std::string_view
+  text () noexcept
+  {
+    return Literal.view ();
+  }
+
+  static constexpr size_t
+  size () noexcept
+  {
+    return token_count;
+  }
+
+  static constexpr const json_literal_token &
+  token (const size_t index) noexcept
+  {
+    return tokens[index];
+  }
+
+  Json
+  to_json () const
+  {
+    size_t index{};
+    return build (index);
+  }
+
+  operator Json () const { return to_json (); }
+};
+
+// R"({"a": 1})"_json_checked: compile-time validated, parsed at runtime.
+template <json_literal Literal>
+Json
+operator""_json_checked ()
+{
+  return parse (Literal.view ()).result_value.value ();
+}
+
+// R"({"a": 1})"_json_compiled: validated and tokenized at compile time.
+template <json_literal Literal>
+constexpr compiled_json<Literal>
+operator""_json_compiled ()
+{
+  return {};
+}
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_LITERAL_H
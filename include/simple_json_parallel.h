@@ -0,0 +1,146 @@
+#ifndef SIMPLE_JSON_PARALLEL_H
+#define SIMPLE_JSON_PARALLEL_H
+
+#include "simple_json.h"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+
+// Splits [0, count) into chunks of at least min_chunk_size indices and runs
+// task (begin, end) on each of them, on a library owned thread pool that
+// the calling thread joins. Idle threads pick up the next unclaimed chunk,
+// so uneven chunks balance out. Nested calls and calls made while another
+// thread uses the pool run on the calling thread. The first exception
+// thrown by task is rethrown once every chunk has finished.
+void parallel_for_chunks (
+    size_t count, size_t min_chunk_size,
+    const std::function<void (size_t begin, size_t end)> &task);
+
+// Number of threads parallel_for_chunks () uses, the caller included.
+size_t parallel_concurrency () noexcept;
+
+// The algorithms below require an array valued Json and throw
+// std::invalid_argument for anything else. Callables run concurrently on
+// different elements and must not touch other elements of the array.
+
+inline constexpr size_t parallel_min_chunk_size{ 1024 };
+
+namespace parallel_helpers
+{
+
+inline std::vector<Json> &
+elements_of (Json &json)
+{
+  if (auto json_array = json.get_json_value_as_array ())
+    return json_array->get ();
+  throw std::invalid_argument{ "expected a JSON array" };
+}
+
+inline const std::vector<Json> &
+elements_of (const Json &json)
+{
+  if (auto json_array = json.get_json_value_as_array ())
+    return json_array->get ();
+  throw std::invalid_argument{ "expected a JSON array" };
+}
+
+} // namespace parallel_helpers
+
+template <std::invocable<Json &> Function>
+void
+parallel_for_each (Json &json, Function function)
+{
+  std::vector<Json> &elements{ parallel_helpers::elements_of (json) };
+  parallel_for_chunks (elements.size (), parallel_min_chunk_size,
+                       [&] (const size_t begin, const size_t end) {
+                         for (size_t i{ begin }; i < end; ++i)
+                           function (elements[i]);
+                       });
+}
+
+template <std::invocable<const Json &> Function>
+void
+parallel_for_each (const Json &json, Function function)
+{
+  const std::vector<Json> &elements{ parallel_helpers::elements_of (json) };
+  parallel_for_chunks (elements.size (), parallel_min_chunk_size,
+                       [&] (const size_t begin, const size_t end) {
+                         for (size_t i{ begin }; i < end; ++i)
+                           function (elements[i]);
+                       });
+}
+
+// Returns a new array holding function (element) for every element.
+template <std::invocable<const Json &> Function>
+  requires std::same_as<std::invoke_result_t<Function, const Json &>, Json>
+Json
+parallel_transform (const Json &json, Function function)
+{
+  const std::vector<Json> &elements{ parallel_helpers::elements_of (json) };
+  std::vector<Json> results (elements.size ());
+  parallel_for_chunks (elements.size (), parallel_min_chunk_size,
+                       [&] (const size_t begin, const size_t end) {
+                         for (size_t i{ begin }; i < end; ++i)
+                           results[i] = function (elements[i]);
+                       });
+  return Json{ std::move (results) };
+}
+
+// Folds transform (element) with reduce, which must be associative: each
+// chunk is folded starting from init and the partial results are folded in
+// chunk order, so init should be the identity of reduce.
+template <typename T, typename Reduce, typename Transform>
+  requires std::invocable<Transform, const Json &>
+           && std::invocable<Reduce, T, T>
+T
+parallel_reduce (const Json &json, T init, Reduce reduce, Transform transform)
+{
+  const std::vector<Json> &elements{ parallel_helpers::elements_of (json) };
+  std::vector<std::pair<size_t, T> > partials;
+  std::mutex partials_mutex;
+  parallel_for_chunks (elements.size (), parallel_min_chunk_size,
+                       [&] (const size_t begin, const size_t end) {
+                         T partial{ init };
+                         for (size_t i{ begin }; i < end; ++i)
+                           partial = reduce (std::move (partial),
+                                             transform (elements[i]));
+                         std::lock_guard lock{ partials_mutex };
+                         partials.emplace_back (begin, std::move (partial));
+                       });
+  std::ranges::sort (partials, {}, &std::pair<size_t, T>::first);
+  T result{ std::move (init) };
+  for (auto &[begin, partial] : partials)
+    result = reduce (std::move (result), std::move (partial));
+  return result;
+}
+
+template <std::predicate<const Json &> Predicate>
+size_t
+parallel_count_if (const Json &json, Predicate predicate)
+{
+  return parallel_reduce (json, size_t{}, std::plus<> (),
+                          [&] (const Json &element) -> size_t {
+                            return predicate (element) ? 1 : 0;
+                          });
+}
+
+// Stable sort of the array elements by the value found at json_pointer in
+// each element. Elements lacking that value come first, then values order
+// by type (null, bool, number, string, array, object) and within a type by
+// value; arrays and objects keep their relative order.
+void parallel_sort_by (Json &json, std::string_view json_pointer);
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_PARALLEL_H
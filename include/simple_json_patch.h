@@ -0,0 +1,65 @@
+#ifndef SIMPLE_JSON_PATCH_H
+#define SIMPLE_JSON_PATCH_H
+
+#include "simple_json.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace simple_json
+{
+
+enum class json_patch_op
+{
+  add,
+  remove,
+  replace,
+  move,
+  copy,
+  test
+};
+
+// One RFC 6902 operation. from is only used by move and copy, value only by
+// add, replace and test.
+struct json_patch_operation
+{
+  json_patch_op op{};
+  std::string path{};
+  std::string from{};
+  Json value{ nullptr };
+};
+
+using json_patch = std::vector<json_patch_operation>;
+
+// Returns a patch that turns source into target. Objects are diffed key by
+// key, arrays with a linear space Myers (O((N + M) D) time) diff over
+// element hashes so that only the inserted, removed and changed elements
+// show up in the patch.
+json_patch diff (const Json &source, const Json &target);
+
+// Applies patch to document. The patch is applied atomically: if any
+// operation fails (including test) std::invalid_argument is thrown and
+// document is left unchanged. document is switched to copy-on-write mode
+// (see Json::share ()), so only the paths the patch touches are copied.
+void apply_patch (Json &document, const json_patch &patch);
+
+// RFC 7386 JSON Merge Patch: members of patch replace those of target,
+// null members remove them. The rvalue overload splices the patch's object
+// nodes into target instead of copying them.
+void merge_patch (Json &target, const Json &patch);
+void merge_patch (Json &target, Json &&patch);
+
+// Applies a merge patch given as JSON text without building the patch Json
+// first: only the replaced leaf values are materialized. Malformed text
+// throws std::invalid_argument and leaves target unchanged.
+void merge_patch_from_string (Json &target, std::string_view patch);
+
+// Conversions between json_patch and its JSON array representation
+// ([{"op": "add", "path": "/a", "value": 1}, ...]).
+Json json_patch_to_json (const json_patch &patch);
+json_patch json_patch_from_json (const Json &json);
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_PATCH_H
@@ -0,0 +1,155 @@
+#ifndef SIMPLE_JSON_PATH_H
+#define SIMPLE_JSON_PATH_H
+
+#include "simple_json.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace simple_json
+{
+
+// RFC 9535 JSONPath query compiled once into flat tables of segments,
+// selectors and filter expressions that reference each other by index, so
+// running it against a document never looks at the query text again.
+// Supported: child and descendant segments, name, wildcard, index, slice
+// and filter selectors, comparisons, &&, ||, ! and the length, count,
+// match, search and value functions (match and search use std::regex).
+// Strings are kept as parse () stores them, escapes included. A malformed
+// or ill-typed query throws std::invalid_argument with its offset.
+class json_path
+{
+public:
+  explicit json_path (std::string_view query);
+
+  // The selected nodes in RFC 9535 order (members of an object come in
+  // the object's iteration order). The pointers refer into json and stay
+  // valid until it is modified.
+  std::vector<const Json *> select (const Json &json) const;
+
+  // Same, but the nodes may be modified in place; shared subtrees along
+  // the way are unshared as with any mutable access.
+  std::vector<Json *> select (Json &json) const;
+
+  // Whether the query only has name and index selectors in child segments
+  // and therefore selects at most one node.
+  bool
+  is_singular () const noexcept
+  {
+    return queries[main_query].is_singular;
+  }
+
+private:
+  static constexpr std::size_t main_query{ 0 };
+  static constexpr std::size_t no_index{
+    std::numeric_limits<std::size_t>::max ()
+  };
+
+  enum class selector_kind
+  {
+    name,
+    wildcard,
+    index,
+    slice,
+    filter
+  };
+
+  struct selector
+  {
+    selector_kind kind{};
+    std::string name;
+    std::int64_t index{};
+    std::optional<std::int64_t> start;
+    std::optional<std::int64_t> end;
+    std::int64_t step{ 1 };
+    std::size_t filter{ no_index };
+  };
+
+  struct segment
+  {
+    bool is_descendant{};
+    std::vector<selector> selectors;
+  };
+
+  struct query
+  {
+    bool is_relative{}; // starts at @ rather than $
+    bool is_singular{ true };
+    std::vector<segment> segments{};
+  };
+
+  enum class expression_kind
+  {
+    logical_or,
+    logical_and,
+    logical_not,
+    comparison,
+    exists, // a query used as a test: true when it selects anything
+    literal,
+    singular_query,
+    length,
+    count,
+    match,
+    search,
+    value
+  };
+
+  enum class comparison_op
+  {
+    equal,
+    not_equal,
+    less,
+    less_equal,
+    greater,
+    greater_equal
+  };
+
+  struct expression
+  {
+    expression_kind kind{};
+    comparison_op op{};
+    std::size_t lhs{ no_index };    // operands and function arguments
+    std::size_t rhs{ no_index };
+    std::size_t target{ no_index }; // query, literal or pattern index
+  };
+
+  // Result of a comparable expression: a node, a computed number or
+  // nothing (a query that selected no node).
+  struct comparable
+  {
+    const Json *node{};
+    std::optional<double> number;
+  };
+
+  class compiler;
+
+  template <typename JsonType>
+  void evaluate (const query &path, JsonType &start, const Json &root,
+                 std::vector<JsonType *> &nodes) const;
+  template <typename JsonType>
+  void select_children (const selector &child, JsonType &json,
+                        const Json &root,
+                        std::vector<JsonType *> &nodes) const;
+
+  const Json *select_singular (const query &path, const Json &current,
+                               const Json &root) const;
+  bool test (std::size_t index, const Json &current, const Json &root) const;
+  comparable evaluate_comparable (std::size_t index, const Json &current,
+                                  const Json &root) const;
+  bool matches (const expression &function, const Json &current,
+                const Json &root) const;
+
+  std::vector<query> queries; // queries[main_query] is the query itself
+  std::vector<expression> expressions;
+  std::vector<Json> literals;
+  std::vector<std::optional<std::regex> > patterns; // nullopt: invalid
+};
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_PATH_H
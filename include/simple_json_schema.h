@@ -0,0 +1,127 @@
+#ifndef SIMPLE_JSON_SCHEMA_H
+#define SIMPLE_JSON_SCHEMA_H
+
+#include "simple_json.h"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace simple_json
+{
+
+class json_reader;
+
+struct schema_violation
+{
+  std::string path; // JSON pointer of the offending value
+  std::string message;
+};
+
+// JSON Schema compiled into a flat table of nodes that reference each other
+// by index. Property lookups are hashed, required keys are tracked with
+// bit masks and patterns are compiled once. Supported keywords: type, enum,
+// const, minimum, maximum, exclusiveMinimum, exclusiveMaximum, multipleOf,
+// minLength, maxLength, pattern, properties, required,
+// additionalProperties, minProperties, maxProperties, items, minItems and
+// maxItems; annotations are ignored. A malformed schema or an unsupported
+// keyword ($ref, allOf, uniqueItems, ...) throws std::invalid_argument.
+class json_schema
+{
+public:
+  explicit json_schema (const Json &schema);
+
+  std::optional<schema_violation> validate (const Json &json) const;
+
+  // Validates JSON text in a single pass without building a Json tree
+  // (only enum / const candidates are materialized).
+  std::optional<schema_violation> validate (std::string_view input) const;
+
+  // Rejects input violating the schema before any tree is built, then
+  // parses it.
+  result_type parse (std::string_view input) const;
+
+private:
+  static constexpr std::size_t accept_all_node{ 0 };
+  static constexpr std::size_t reject_all_node{ 1 };
+  static constexpr std::size_t no_index{
+    std::numeric_limits<std::size_t>::max ()
+  };
+  static constexpr unsigned integer_bit{ 1u << 6 };
+  static constexpr unsigned all_types{ 0x3Fu };
+
+  struct string_hash
+  {
+    using is_transparent = void;
+
+    std::size_t
+    operator() (std::string_view str) const noexcept
+    {
+      return std::hash<std::string_view>{}(str);
+    }
+  };
+
+  struct property
+  {
+    std::size_t node{ no_index }; // no_index: additional_node applies
+    int required_bit{ -1 };
+  };
+
+  struct node
+  {
+    unsigned type_mask{ all_types }; // bit per json_type, plus integer_bit
+    bool has_enum{};
+    std::size_t enum_begin{};
+    std::size_t enum_end{};
+    double minimum{ -std::numeric_limits<double>::infinity () };
+    double maximum{ std::numeric_limits<double>::infinity () };
+    bool is_minimum_exclusive{};
+    bool is_maximum_exclusive{};
+    double multiple_of{}; // 0: no multipleOf
+    std::size_t min_length{};
+    std::size_t max_length{ std::numeric_limits<std::size_t>::max () };
+    std::size_t pattern{ no_index };
+    std::unordered_map<std::string, property, string_hash, std::equal_to<> >
+        properties;
+    std::vector<std::string> required; // indexed by required_bit
+    std::size_t additional_node{ accept_all_node };
+    std::size_t min_properties{};
+    std::size_t max_properties{ std::numeric_limits<std::size_t>::max () };
+    std::size_t items_node{ accept_all_node };
+    std::size_t min_items{};
+    std::size_t max_items{ std::numeric_limits<std::size_t>::max () };
+  };
+
+  class required_tracker;
+
+  std::size_t compile (const Json &schema);
+
+  bool validate_tree (std::size_t index, const Json &json,
+                      schema_violation &violation) const;
+  bool validate_text (std::size_t index, json_reader &reader,
+                      schema_violation &violation) const;
+  bool check_type (const node &schema_node, json_type type, double number,
+                   schema_violation &violation) const;
+  bool check_number (const node &schema_node, double number,
+                     schema_violation &violation) const;
+  bool check_string (const node &schema_node, std::string_view str,
+                     schema_violation &violation) const;
+  bool check_property_count (const node &schema_node, std::size_t count,
+                             schema_violation &violation) const;
+
+  std::vector<node> nodes;
+  std::vector<Json> enum_values;
+  std::vector<std::regex> patterns;
+  std::vector<std::string> pattern_sources;
+  std::size_t root{};
+};
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_SCHEMA_H
@@ -0,0 +1,192 @@
+#ifndef SIMPLE_JSON_SNAPSHOT_H
+#define SIMPLE_JSON_SNAPSHOT_H
+
+#include "simple_json.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace simple_json
+{
+
+// Immutable JSON document. Only const access to the tree is exposed, so any
+// number of threads can read the same frozen_json (or copies of it)
+// concurrently without synchronization. Copies are O(1).
+class frozen_json
+{
+public:
+  frozen_json () : root{ std::make_shared<const Json> () } {}
+
+  explicit frozen_json (Json json)
+      : root{ std::make_shared<const Json> (std::move (json.share ())) }
+  {
+  }
+
+  const Json &
+  get () const noexcept
+  {
+    return *root;
+  }
+
+  const Json &
+  operator* () const noexcept
+  {
+    return *root;
+  }
+
+  const Json *
+  operator->() const noexcept
+  {
+    return root.get ();
+  }
+
+  const Json &
+  at (const std::string &key) const
+  {
+    return root->at (key);
+  }
+
+  const Json &
+  operator[] (const std::string &key) const
+  {
+    return (*root)[key];
+  }
+
+  std::string
+  to_string (int indent = 0) const
+  {
+    return root->to_string (indent);
+  }
+
+  // Returns a mutable copy sharing all subtrees with this document.
+  Json
+  thaw () const
+  {
+    return *root;
+  }
+
+private:
+  friend class json_snapshot_holder;
+
+  explicit frozen_json (std::shared_ptr<const Json> root) noexcept
+      : root{ std::move (root) }
+  {
+  }
+
+  std::shared_ptr<const Json> root;
+};
+
+// RCU style holder of the current frozen_json. Writers publish a new
+// document with store () while readers keep using the snapshot they
+// obtained; old snapshots are reclaimed when their last reader drops them.
+class json_snapshot_holder
+{
+public:
+  class reader;
+
+  json_snapshot_holder () : current{ frozen_json{}.root } {}
+
+  explicit json_snapshot_holder (frozen_json document)
+      : current{ std::move (document.root) }
+  {
+  }
+
+  json_snapshot_holder (const json_snapshot_holder &) = delete;
+  json_snapshot_holder &operator= (const json_snapshot_holder &) = delete;
+
+  frozen_json
+  load () const
+  {
+    return frozen_json{ current.load (std::memory_order_acquire) };
+  }
+
+  void
+  store (frozen_json document)
+  {
+    current.store (std::move (document.root), std::memory_order_release);
+    generation.fetch_add (1, std::memory_order_release);
+  }
+
+  void
+  store (Json json)
+  {
+    store (frozen_json{ std::move (json) });
+  }
+
+  // Atomically replaces the document with update (thawed copy), retrying
+  // if another writer published in the meantime.
+  template <typename Update>
+  void
+  update (Update update)
+  {
+    std::shared_ptr<const Json> expected{ current.load (
+        std::memory_order_acquire) };
+    while (true)
+      {
+        Json json = *expected;
+        update (json);
+        std::shared_ptr<const Json> desired{ std::make_shared<const Json> (
+            std::move (json.share ())) };
+        if (current.compare_exchange_weak (expected, std::move (desired),
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_acquire))
+          break;
+      }
+    generation.fetch_add (1, std::memory_order_release);
+  }
+
+  std::uint64_t
+  version () const noexcept
+  {
+    return generation.load (std::memory_order_acquire);
+  }
+
+  reader get_reader () const;
+
+private:
+  std::atomic<std::shared_ptr<const Json> > current;
+  std::atomic<std::uint64_t> generation{};
+};
+
+// Per-thread read handle. As long as no new document has been published
+// get () costs a single atomic load of the generation counter: no lock and
+// no reference count traffic on the shared document.
+class json_snapshot_holder::reader
+{
+public:
+  explicit reader (const json_snapshot_holder &holder)
+      : holder{ &holder }, cached_version{ holder.version () },
+        cached_document{ holder.load () }
+  {
+  }
+
+  const frozen_json &
+  get ()
+  {
+    const std::uint64_t latest_version{ holder->version () };
+    if (latest_version != cached_version)
+      {
+        cached_document = holder->load ();
+        cached_version = latest_version;
+      }
+    return cached_document;
+  }
+
+private:
+  const json_snapshot_holder *holder;
+  std::uint64_t cached_version;
+  frozen_json cached_document;
+};
+
+inline json_snapshot_holder::reader
+json_snapshot_holder::get_reader () const
+{
+  return reader{ *this };
+}
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_SNAPSHOT_H
@@ -0,0 +1,363 @@
+#ifndef SIMPLE_JSON_TAPE_H
+#define SIMPLE_JSON_TAPE_H
+
+#include "simple_json.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <vector>
+
+namespace simple_json
+{
+
+class json_tape;
+struct json_tape_member;
+
+// Read-only view of one value on a json_tape. Views are cheap to copy and
+// stay valid while the tape they refer to is alive (moving the tape does
+// not invalidate them).
+//
+// Tape layout: one 64 bit word per value, its tag in the top byte.
+// - 'n', 't', 'f': null, true and false.
+// - 'd': a number, whose bits are in the next word.
+// - 's': a string; the payload is its offset in the string buffer and the
+//   next word its length. Strings are stored as in the input, like parse ()
+//   does, escapes included.
+// - '[' and '{': the payload is the index one past the matching ']' or '}'
+//   word, whose payload is the element or member count. Object members are
+//   a key string followed by the value.
+class json_tape_view
+{
+public:
+  class value_iterator;
+  class member_iterator;
+
+  // A null value that belongs to no tape.
+  json_tape_view () noexcept : json_tape_view{ &null_word, nullptr, 0 } {}
+
+  json_type get_json_element_type () const noexcept;
+
+  bool
+  is_json_object () const noexcept
+  {
+    return tag () == '{';
+  }
+
+  bool
+  is_json_array () const noexcept
+  {
+    return tag () == '[';
+  }
+
+  bool
+  is_json_string () const noexcept
+  {
+    return tag () == 's';
+  }
+
+  bool
+  is_json_number () const noexcept
+  {
+    return tag () == 'd';
+  }
+
+  bool
+  is_json_boolean () const noexcept
+  {
+    return tag () == 't' || tag () == 'f';
+  }
+
+  bool
+  is_json_null () const noexcept
+  {
+    return tag () == 'n';
+  }
+
+  double
+  to_number () const noexcept
+  {
+    return is_json_number () ? std::bit_cast<double> (words[index + 1])
+                             : std::numeric_limits<double>::quiet_NaN ();
+  }
+
+  bool
+  to_bool () const noexcept
+  {
+    return tag () == 't';
+  }
+
+  std::optional<bool> get_json_value_as_bool () const noexcept;
+  std::optional<double> get_json_value_as_number () const noexcept;
+  std::optional<std::string_view> get_json_value_as_string () const noexcept;
+
+  // Elements of an array or members of an object; 0 for anything else.
+  size_t size () const noexcept;
+
+  // Linear scan over the members; the last of duplicate keys wins, as in
+  // parse ().
+  std::optional<json_tape_view> find (std::string_view key) const noexcept;
+
+  // Throws std::invalid_argument for non-objects and std::out_of_range for
+  // missing keys, like Json::get_json_element_if_exists ().
+  json_tape_view at (std::string_view key) const;
+
+  // A null view for non-objects and missing keys.
+  json_tape_view
+  operator[] (std::string_view key) const noexcept
+  {
+    return find (key).value_or (json_tape_view{});
+  }
+
+  // Elements of an array, member values of an object, empty otherwise.
+  auto values () const noexcept;
+
+  // Members of an object, empty otherwise.
+  auto items () const noexcept;
+
+  auto keys () const noexcept;
+
+  // begin () / end () iterate object members, as they do on Json.
+  member_iterator begin () const noexcept;
+  member_iterator end () const noexcept;
+
+  // Deep copy into a regular Json tree.
+  Json to_json () const;
+
+private:
+  friend class json_tape;
+
+  static constexpr std::uint64_t null_word{ std::uint64_t{ 'n' } << 56 };
+
+  json_tape_view (const std::uint64_t *words, const char *strings,
+                  const size_t index) noexcept
+      : words{ words }, strings{ strings }, index{ index }
+  {
+  }
+
+  char
+  tag () const noexcept
+  {
+    return static_cast<char> (words[index] >> 56);
+  }
+
+  std::uint64_t
+  payload () const noexcept
+  {
+    return words[index] & ((std::uint64_t{ 1 } << 56) - 1);
+  }
+
+  // Index of the word following this value.
+  size_t
+  next_index () const noexcept
+  {
+    switch (tag ())
+      {
+      case '[':
+      case '{':
+        return payload ();
+      case 'd':
+      case 's':
+        return index + 2;
+      default:
+        return index + 1;
+      }
+  }
+
+  json_tape_view
+  at_index (const size_t other) const noexcept
+  {
+    return json_tape_view{ words, strings, other };
+  }
+
+  const std::uint64_t *words;
+  const char *strings;
+  size_t index;
+};
+
+struct json_tape_member
+{
+  std::string_view key;
+  json_tape_view value;
+};
+
+class json_tape_view::value_iterator
+{
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = json_tape_view;
+  using difference_type = std::ptrdiff_t;
+
+  value_iterator () = default;
+
+  value_iterator (const json_tape_view position, const bool is_member) noexcept
+      : position{ position }, is_member{ is_member }
+  {
+  }
+
+  json_tape_view
+  operator* () const noexcept
+  {
+    return is_member ? position.at_index (position.index + 2) : position;
+  }
+
+  value_iterator &
+  operator++ () noexcept
+  {
+    position.index = (**this).next_index ();
+    return *this;
+  }
+
+  value_iterator
+  operator++ (int) noexcept
+  {
+    value_iterator tmp{ *this };
+    ++(*this);
+    return tmp;
+  }
+
+  bool
+  operator== (const value_iterator &rhs) const noexcept
+  {
+    return position.index == rhs.position.index;
+  }
+
+private:
+  json_tape_view position;
+  bool is_member{};
+};
+
+class json_tape_view::member_iterator
+{
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = json_tape_member;
+  using difference_type = std::ptrdiff_t;
+
+  member_iterator () = default;
+
+  explicit member_iterator (const json_tape_view position) noexcept
+      : position{ position }
+  {
+  }
+
+  json_tape_member
+  operator* () const noexcept
+  {
+    return { *position.get_json_value_as_string (),
+             position.at_index (position.index + 2) };
+  }
+
+  member_iterator &
+  operator++ () noexcept
+  {
+    position.index = position.at_index (position.index + 2).next_index ();
+    return *this;
+  }
+
+  member_iterator
+  operator++ (int) noexcept
+  {
+    member_iterator tmp{ *this };
+    ++(*this);
+    return tmp;
+  }
+
+  bool
+  operator== (const member_iterator &rhs) const noexcept
+  {
+    return position.index == rhs.position.index;
+  }
+
+private:
+  json_tape_view position;
+};
+
+inline auto
+json_tape_view::values () const noexcept
+{
+  using view = std::ranges::subrange<value_iterator>;
+  if (!is_json_array () && !is_json_object ())
+    return view{};
+  return view{ value_iterator{ at_index (index + 1), is_json_object () },
+               value_iterator{ at_index (payload () - 1), is_json_object () } };
+}
+
+inline auto
+json_tape_view::items () const noexcept
+{
+  return std::ranges::subrange<member_iterator>{ begin (), end () };
+}
+
+inline auto
+json_tape_view::keys () const noexcept
+{
+  return items () | std::views::transform (&json_tape_member::key);
+}
+
+// A whole document in two buffers: the tape of 64 bit words and the bytes
+// of all strings. The value tree is laid out in document order, so walking
+// it reads memory sequentially, and parsing allocates about twice: once
+// per buffer, both reserved up front from the input size.
+class json_tape
+{
+public:
+  json_tape () : words{ json_tape_view::null_word } {}
+
+  json_tape_view
+  root () const noexcept
+  {
+    return json_tape_view{ words.data (), strings.data (), 0 };
+  }
+
+  json_tape_view
+  at (const std::string_view key) const
+  {
+    return root ().at (key);
+  }
+
+  json_tape_view
+  operator[] (const std::string_view key) const noexcept
+  {
+    return root ()[key];
+  }
+
+  size_t
+  word_count () const noexcept
+  {
+    return words.size ();
+  }
+
+  size_t
+  string_bytes () const noexcept
+  {
+    return strings.size ();
+  }
+
+  Json
+  to_json () const
+  {
+    return root ().to_json ();
+  }
+
+private:
+  friend json_tape parse_tape (std::string_view input);
+
+  std::vector<std::uint64_t> words;
+  std::vector<char> strings;
+};
+
+// Parses strict JSON (no trailing commas or data after the value) into a
+// tape without building any Json. Throws std::invalid_argument with the
+// offset of the first error.
+json_tape parse_tape (std::string_view input);
+
+} // namespace simple_json
+
+#endif // SIMPLE_JSON_TAPE_H
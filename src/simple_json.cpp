@@ -3,7 +3,17 @@
 //
 
 #include "../include/simple_json.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <stack>
+#include <unordered_set>
+
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+#include <mutex>
+#endif
 
 namespace simple_json
 {
@@ -16,6 +26,754 @@ inline static constexpr size_t TRUE_STRING_LEN{ len (TRUE_STRING) };
 inline static constexpr size_t FALSE_STRING_LEN{ len (FALSE_STRING) };
 inline static constexpr size_t NULL_STRING_LEN{ len (NULL_STRING) };
 
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+namespace
+{
+std::mutex statistics_callback_mutex;
+std::function<void (const json_statistics &)> statistics_callback;
+thread_local json_statistics current_statistics;
+thread_local json_statistics *active_statistics{};
+thread_local size_t current_depth{};
+
+// Only the outermost scope on a thread collects, so nested print_value and
+// parse calls made while a collection is running are folded into it.
+class statistics_scope
+{
+public:
+  explicit statistics_scope (const json_operation operation)
+      : is_outermost{ active_statistics == nullptr }
+  {
+    if (!is_outermost)
+      return;
+    current_statistics = json_statistics{ operation };
+    active_statistics = &current_statistics;
+    current_depth = 0;
+    start_time = std::chrono::steady_clock::now ();
+  }
+
+  statistics_scope (const statistics_scope &) = delete;
+  statistics_scope &operator= (const statistics_scope &) = delete;
+
+  ~statistics_scope ()
+  {
+    if (is_outermost)
+      active_statistics = nullptr;
+  }
+
+  void
+  finish (const size_t bytes_processed)
+  {
+    if (!is_outermost)
+      return;
+    current_statistics.elapsed = std::chrono::steady_clock::now ()
+                                 - start_time;
+    current_statistics.bytes_processed = bytes_processed;
+    active_statistics = nullptr;
+
+    std::function<void (const json_statistics &)> callback;
+    {
+      std::lock_guard lock{ statistics_callback_mutex };
+      callback = statistics_callback;
+    }
+    if (callback)
+      callback (current_statistics);
+  }
+
+private:
+  bool is_outermost;
+  std::chrono::steady_clock::time_point start_time;
+};
+
+class depth_scope
+{
+public:
+  depth_scope () noexcept
+  {
+    if (active_statistics != nullptr)
+      active_statistics->max_depth
+          = std::max (active_statistics->max_depth, ++current_depth);
+  }
+
+  depth_scope (const depth_scope &) = delete;
+  depth_scope &operator= (const depth_scope &) = delete;
+
+  ~depth_scope ()
+  {
+    if (active_statistics != nullptr)
+      --current_depth;
+  }
+};
+
+void
+record_string_allocation (const std::string &str) noexcept
+{
+  static const size_t small_string_capacity{ std::string{}.capacity () };
+  if (active_statistics == nullptr || str.capacity () <= small_string_capacity)
+    return;
+  ++active_statistics->allocation_count;
+  active_statistics->allocated_bytes += str.capacity () + 1;
+}
+
+void
+record_value (const JSONValue &value, const bool is_allocation_tracked) noexcept
+{
+  if (active_statistics == nullptr)
+    return;
+  json_statistics &statistics{ *active_statistics };
+  if (std::holds_alternative<json_raw_number> (value))
+    ++statistics.node_counts[static_cast<size_t> (json_type::number_t)];
+  else if (std::holds_alternative<json_number_array> (value))
+    ++statistics.node_counts[static_cast<size_t> (json_type::array_t)];
+  else
+    ++statistics.node_counts[value.index ()];
+
+  if (const auto *str = std::get_if<std::string> (&value))
+    {
+      statistics.largest_string
+          = std::max (statistics.largest_string, str->size ());
+      if (is_allocation_tracked)
+        record_string_allocation (*str);
+    }
+  else if (const auto *json_array = std::get_if<std::vector<Json> > (&value))
+    {
+      statistics.largest_array
+          = std::max (statistics.largest_array, json_array->size ());
+      if (is_allocation_tracked && json_array->capacity () != 0)
+        {
+          ++statistics.allocation_count;
+          statistics.allocated_bytes += json_array->capacity () * sizeof (Json);
+        }
+    }
+  else if (const auto *numbers = std::get_if<json_number_array> (&value))
+    {
+      statistics.node_counts[static_cast<size_t> (json_type::number_t)]
+          += numbers->values ().size ();
+      statistics.largest_array
+          = std::max (statistics.largest_array, numbers->values ().size ());
+      if (is_allocation_tracked && numbers->values ().capacity () != 0)
+        {
+          ++statistics.allocation_count;
+          statistics.allocated_bytes
+              += numbers->values ().capacity () * sizeof (double);
+        }
+    }
+  else if (const auto *json_object
+           = std::get_if<std::unordered_map<std::string, Json> > (&value))
+    {
+      statistics.largest_object
+          = std::max (statistics.largest_object, json_object->size ());
+      if (is_allocation_tracked && !json_object->empty ())
+        {
+          // one node per member plus the bucket array
+          statistics.allocation_count += json_object->size () + 1;
+          statistics.allocated_bytes
+              += json_object->size ()
+                     * (sizeof (std::pair<const std::string, Json>)
+                        + 2 * sizeof (void *))
+                 + json_object->bucket_count () * sizeof (void *);
+        }
+    }
+}
+}
+
+void
+set_statistics_callback (
+    std::function<void (const json_statistics &)> callback)
+{
+  std::lock_guard lock{ statistics_callback_mutex };
+  statistics_callback = std::move (callback);
+}
+
+const json_statistics &
+last_statistics () noexcept
+{
+  return current_statistics;
+}
+#endif
+
+namespace
+{
+
+const size_t small_string_capacity{ std::string{}.capacity () };
+
+// State of a parse () call given parse_options: the options, what has been
+// consumed so far against their limits and the pool of a parser, if any.
+class parse_context
+{
+public:
+  parse_context (const parse_options &options, json_node_pool *pool) noexcept
+      : options{ options }, pool{ pool }
+  {
+  }
+
+  // Counts one more value starting at pos.
+  std::optional<std::string>
+  add_value (const size_t pos)
+  {
+    ++element_count;
+    if (options.max_element_count != 0
+        && element_count > options.max_element_count)
+      return std::format ("Maximum element count of {} exceeded at offset {}!",
+                          options.max_element_count, pos);
+    if (options.deadline && element_count % 4096 == 0
+        && std::chrono::steady_clock::now () > *options.deadline)
+      return std::format ("Parse deadline exceeded at offset {}!", pos);
+    return std::nullopt;
+  }
+
+  std::optional<std::string>
+  enter_nesting (const size_t pos)
+  {
+    if (options.max_depth != 0 && depth == options.max_depth)
+      return std::format ("Maximum nesting depth of {} exceeded at offset {}!",
+                          options.max_depth, pos);
+    ++depth;
+    return std::nullopt;
+  }
+
+  void
+  leave_nesting () noexcept
+  {
+    --depth;
+  }
+
+  std::optional<std::string>
+  add_string (const size_t length, const size_t pos)
+  {
+    if (options.max_string_length != 0 && length > options.max_string_length)
+      return std::format ("Maximum string length of {} exceeded at offset {}!",
+                          options.max_string_length, pos);
+    return length > small_string_capacity ? add_allocation (length + 1, pos)
+                                          : std::nullopt;
+  }
+
+  std::optional<std::string>
+  add_allocation (const size_t bytes, const size_t pos)
+  {
+    allocated_bytes += bytes;
+    if (options.max_allocated_bytes != 0
+        && allocated_bytes > options.max_allocated_bytes)
+      return std::format (
+          "Maximum allocated bytes of {} exceeded at offset {}!",
+          options.max_allocated_bytes, pos);
+    return std::nullopt;
+  }
+
+  const parse_options &options;
+  json_node_pool *const pool;
+
+private:
+  size_t depth{};
+  size_t element_count{};
+  size_t allocated_bytes{};
+};
+
+// Context of the parse () call running on this thread, if it was given
+// parse_options.
+thread_local parse_context *active_parse_context{};
+
+class parse_context_scope
+{
+public:
+  parse_context_scope (const parse_options &options,
+                       json_node_pool *pool) noexcept
+      : context{ options, pool },
+        previous{ std::exchange (active_parse_context, &context) }
+  {
+  }
+
+  parse_context_scope (const parse_context_scope &) = delete;
+  parse_context_scope &operator= (const parse_context_scope &) = delete;
+
+  ~parse_context_scope () { active_parse_context = previous; }
+
+private:
+  parse_context context;
+  parse_context *previous;
+};
+
+result_type
+limit_failure (std::string message)
+{
+  return result_type{ std::nullopt, status::fail, std::move (message) };
+}
+
+json_node_pool *
+active_pool () noexcept
+{
+  return active_parse_context != nullptr ? active_parse_context->pool
+                                         : nullptr;
+}
+
+std::vector<Json>
+take_array ()
+{
+  json_node_pool *pool{ active_pool () };
+  if (pool == nullptr || pool->arrays.empty ())
+    return {};
+  std::vector<Json> json_array{ std::move (pool->arrays.back ()) };
+  pool->arrays.pop_back ();
+  return json_array;
+}
+
+std::vector<double>
+take_number_array ()
+{
+  json_node_pool *pool{ active_pool () };
+  if (pool == nullptr || pool->number_arrays.empty ())
+    return {};
+  std::vector<double> numbers{ std::move (pool->number_arrays.back ()) };
+  pool->number_arrays.pop_back ();
+  return numbers;
+}
+
+std::unordered_map<std::string, Json>
+take_object ()
+{
+  json_node_pool *pool{ active_pool () };
+  if (pool == nullptr || pool->objects.empty ())
+    return {};
+  std::unordered_map<std::string, Json> json_object{ std::move (
+      pool->objects.back ()) };
+  pool->objects.pop_back ();
+  return json_object;
+}
+
+std::string
+take_string (const std::string_view text)
+{
+  json_node_pool *pool{ active_pool () };
+  if (pool == nullptr || pool->strings.empty ()
+      || text.size () <= small_string_capacity)
+    return std::string{ text };
+  std::string str{ std::move (pool->strings.back ()) };
+  pool->strings.pop_back ();
+  str.assign (text);
+  return str;
+}
+
+// Later duplicates of a key replace earlier ones.
+void
+insert_member (std::unordered_map<std::string, Json> &json_object,
+               std::string &&key, Json &&value)
+{
+  json_node_pool *pool{ active_pool () };
+  if (pool == nullptr || pool->members.empty ())
+    {
+      json_object.insert_or_assign (std::move (key), std::move (value));
+      return;
+    }
+  auto member{ std::move (pool->members.back ()) };
+  pool->members.pop_back ();
+  member.key ().swap (key);
+  member.mapped () = std::move (value);
+  auto inserted{ json_object.insert (std::move (member)) };
+  if (!inserted.inserted)
+    {
+      inserted.position->second = std::move (inserted.node.mapped ());
+      pool->members.push_back (std::move (inserted.node));
+    }
+  // key now holds the buffer of the member's previous key
+  if (key.capacity () > small_string_capacity)
+    pool->strings.push_back (std::move (key));
+}
+
+bool
+is_eight_digits (const std::uint64_t chunk) noexcept
+{
+  return ((chunk & 0xF0F0F0F0F0F0F0F0ULL)
+          | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+         == 0x3333333333333333ULL;
+}
+
+// Value of eight ASCII digits loaded little endian, in three multiplies.
+std::uint64_t
+eight_digits_value (std::uint64_t chunk) noexcept
+{
+  chunk -= 0x3030303030303030ULL;
+  chunk = chunk * 10 + (chunk >> 8);
+  return (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+          + (((chunk >> 16) & 0x000000FF000000FFULL)
+             * (1 + (10000ULL << 32))))
+         >> 32;
+}
+
+bool
+is_number_char (const std::string_view str, const size_t pos) noexcept
+{
+  const char ch{ str[pos] };
+  return std::isdigit (static_cast<unsigned char> (ch)) || ch == '.'
+         || ch == 'e' || ch == 'E'
+         || ((ch == '+' || ch == '-')
+             && (str[pos - 1] == 'e' || str[pos - 1] == 'E'));
+}
+
+// Converts the number token at pos, delimited as parse_json_number ()
+// delimits it. Integers of up to 19 digits are accumulated directly, eight
+// digits per step; anything else goes through std::from_chars. Returns
+// false, leaving pos unspecified, if the token is not entirely a number.
+bool
+scan_number (const std::string_view str, size_t &pos, double &number) noexcept
+{
+  const size_t start{ pos };
+  const bool is_negative{ str[pos] == '-' };
+  if (is_negative)
+    ++pos;
+  if (pos >= str.size () || !std::isdigit (static_cast<unsigned char> (str[pos])))
+    return false;
+
+  std::uint64_t mantissa{};
+  const size_t digits_start{ pos };
+  if constexpr (std::endian::native == std::endian::little)
+    {
+      std::uint64_t chunk;
+      while (str.size () - pos >= sizeof chunk
+             && (std::memcpy (&chunk, str.data () + pos, sizeof chunk),
+                 is_eight_digits (chunk)))
+        {
+          mantissa = mantissa * 100000000 + eight_digits_value (chunk);
+          pos += sizeof chunk;
+        }
+    }
+  while (pos < str.size () && std::isdigit (static_cast<unsigned char> (str[pos])))
+    mantissa = mantissa * 10 + static_cast<unsigned> (str[pos++] - '0');
+  if ((pos == str.size () || !is_number_char (str, pos))
+      && pos - digits_start <= 19)
+    {
+      number = static_cast<double> (mantissa);
+      if (is_negative)
+        number = -number;
+      return true;
+    }
+
+  while (pos < str.size () && is_number_char (str, pos))
+    ++pos;
+  const auto [ptr, ec] = std::from_chars (str.data () + start,
+                                          str.data () + pos, number);
+  return ec == std::errc{} && ptr == str.data () + pos;
+}
+
+// Parses array elements into numbers for as long as they are numbers, pos
+// being past the '['. Returns the json_number_array once the ']' is reached
+// or a limit failure; returns std::nullopt with pos at the first element
+// that is not a number.
+std::optional<result_type>
+parse_number_elements (const std::string_view str, size_t &pos,
+                       std::vector<double> &numbers)
+{
+  parse_context &context{ *active_parse_context };
+  while (pos < str.size () && str[pos] != ']')
+    {
+      const size_t start{ pos };
+      double number;
+      if (!scan_number (str, pos, number))
+        {
+          pos = start;
+          return std::nullopt;
+        }
+      if (auto error = context.add_allocation (sizeof (double), start))
+        return limit_failure (std::move (*error));
+      if (auto error = context.add_value (start))
+        throw std::invalid_argument{ std::move (*error) };
+      numbers.push_back (number);
+      skip_whitespace (str, pos);
+      if (pos < str.size () && str[pos] == ',')
+        ++pos;
+      skip_whitespace (str, pos);
+    }
+  if (pos >= str.size ())
+    return result_type{ std::nullopt, status::fail,
+                        "Expected ']' in JSON array!" };
+  ++pos;
+  return result_type{ std::make_optional<Json> (
+                          Json{ json_number_array{ std::move (numbers) } }),
+                      status::success };
+}
+
+result_type
+parse_in_context (const std::string_view input, const parse_options &options,
+                  json_node_pool *pool)
+{
+  if (options.max_input_bytes != 0 && input.size () > options.max_input_bytes)
+    return limit_failure (std::format (
+        "Maximum input size of {} bytes exceeded: the input has {} bytes!",
+        options.max_input_bytes, input.size ()));
+  if (options.deadline && std::chrono::steady_clock::now () > *options.deadline)
+    return limit_failure ("Parse deadline exceeded at offset 0!");
+  parse_context_scope scope{ options, pool };
+  return parse (input);
+}
+
+void
+append_utf8 (std::string &out, const char32_t code_point)
+{
+  if (code_point < 0x80)
+    out += static_cast<char> (code_point);
+  else if (code_point < 0x800)
+    {
+      out += static_cast<char> (0xC0 | (code_point >> 6));
+      out += static_cast<char> (0x80 | (code_point & 0x3F));
+    }
+  else if (code_point < 0x10000)
+    {
+      out += static_cast<char> (0xE0 | (code_point >> 12));
+      out += static_cast<char> (0x80 | ((code_point >> 6) & 0x3F));
+      out += static_cast<char> (0x80 | (code_point & 0x3F));
+    }
+  else
+    {
+      out += static_cast<char> (0xF0 | (code_point >> 18));
+      out += static_cast<char> (0x80 | ((code_point >> 12) & 0x3F));
+      out += static_cast<char> (0x80 | ((code_point >> 6) & 0x3F));
+      out += static_cast<char> (0x80 | (code_point & 0x3F));
+    }
+}
+
+// Mask of the bits that are clear in every ASCII code unit of a 64 bit word.
+template <char_type CharType>
+constexpr std::uint64_t non_ascii_mask{
+  sizeof (CharType) == 2 ? 0xFF80FF80FF80FF80ULL : 0xFFFFFF80FFFFFF80ULL
+};
+
+// Transcodes UTF-16 or UTF-32 to UTF-8, copying runs of ASCII one 64 bit
+// word at a time. Returns false on unpaired surrogates or code points past
+// U+10FFFF.
+template <char_type CharType>
+bool
+transcode_to_utf8 (const std::basic_string_view<CharType> input,
+                   std::string &out)
+{
+  constexpr size_t units_per_word{ sizeof (std::uint64_t) / sizeof (CharType) };
+  out.reserve (input.size ());
+  size_t i{};
+  while (i < input.size ())
+    {
+      while (input.size () - i >= units_per_word)
+        {
+          std::uint64_t word;
+          std::memcpy (&word, input.data () + i, sizeof word);
+          if ((word & non_ascii_mask<CharType>) != 0)
+            break;
+          for (size_t j{}; j < units_per_word; ++j)
+            out += static_cast<char> (input[i + j]);
+          i += units_per_word;
+        }
+      if (i == input.size ())
+        break;
+
+      char32_t code_point{ static_cast<char32_t> (input[i++]) };
+      if constexpr (sizeof (CharType) == 2)
+        {
+          if (code_point >= 0xD800 && code_point <= 0xDBFF)
+            {
+              if (i == input.size () || input[i] < 0xDC00 || input[i] > 0xDFFF)
+                return false;
+              code_point = 0x10000 + ((code_point - 0xD800) << 10)
+                           + (static_cast<char32_t> (input[i++]) - 0xDC00);
+            }
+          else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+            return false;
+        }
+      else if (code_point > 0x10FFFF
+               || (code_point >= 0xD800 && code_point <= 0xDFFF))
+        return false;
+      append_utf8 (out, code_point);
+    }
+  return true;
+}
+
+// Strict RFC 8259 number grammar, checked without converting the digits.
+bool
+is_json_number_text (const std::string_view text) noexcept
+{
+  size_t i{};
+  const auto skip_digits = [&] () {
+    const size_t start{ i };
+    while (i < text.size () && text[i] >= '0' && text[i] <= '9')
+      ++i;
+    return i - start;
+  };
+  if (i < text.size () && text[i] == '-')
+    ++i;
+  if (i < text.size () && text[i] == '0')
+    ++i;
+  else if (skip_digits () == 0)
+    return false;
+  if (i < text.size () && text[i] == '.')
+    {
+      ++i;
+      if (skip_digits () == 0)
+        return false;
+    }
+  if (i < text.size () && (text[i] == 'e' || text[i] == 'E'))
+    {
+      ++i;
+      if (i < text.size () && (text[i] == '+' || text[i] == '-'))
+        ++i;
+      if (skip_digits () == 0)
+        return false;
+    }
+  return i == text.size ();
+}
+
+template <char_type CharType>
+result_type
+parse_transcoded (const std::basic_string_view<CharType> input,
+                  const parse_options &options)
+{
+  std::string utf8;
+  if (!transcode_to_utf8 (input, utf8))
+    return result_type{ std::nullopt, status::fail,
+                        sizeof (CharType) == 2 ? "Invalid UTF-16 input!"
+                                               : "Invalid UTF-32 input!" };
+  return parse (utf8, options);
+}
+
+} // namespace
+
+bool
+is_valid_utf8 (const std::string_view str) noexcept
+{
+  const auto *ptr{ reinterpret_cast<const unsigned char *> (str.data ()) };
+  const auto *const end{ ptr + str.size () };
+  while (ptr != end)
+    {
+      while (end - ptr >= 16)
+        {
+          std::uint64_t first;
+          std::uint64_t second;
+          std::memcpy (&first, ptr, sizeof first);
+          std::memcpy (&second, ptr + 8, sizeof second);
+          if (((first | second) & 0x8080808080808080ULL) != 0)
+            break;
+          ptr += 16;
+        }
+      if (ptr == end)
+        break;
+      if (*ptr < 0x80)
+        {
+          ++ptr;
+          continue;
+        }
+
+      size_t continuation_count;
+      char32_t code_point;
+      char32_t min_code_point;
+      if ((*ptr & 0xE0) == 0xC0)
+        {
+          continuation_count = 1;
+          code_point = *ptr & 0x1F;
+          min_code_point = 0x80;
+        }
+      else if ((*ptr & 0xF0) == 0xE0)
+        {
+          continuation_count = 2;
+          code_point = *ptr & 0x0F;
+          min_code_point = 0x800;
+        }
+      else if ((*ptr & 0xF8) == 0xF0)
+        {
+          continuation_count = 3;
+          code_point = *ptr & 0x07;
+          min_code_point = 0x10000;
+        }
+      else
+        return false;
+
+      if (static_cast<size_t> (end - ptr) <= continuation_count)
+        return false;
+      for (size_t i{ 1 }; i <= continuation_count; ++i)
+        {
+          if ((ptr[i] & 0xC0) != 0x80)
+            return false;
+          code_point = (code_point << 6) | (ptr[i] & 0x3F);
+        }
+      // overlong encodings, surrogates and code points past U+10FFFF
+      if (code_point < min_code_point || code_point > 0x10FFFF
+          || (code_point >= 0xD800 && code_point <= 0xDFFF))
+        return false;
+      ptr += continuation_count + 1;
+    }
+  return true;
+}
+
+namespace
+{
+
+// Folds four interleaved lanes, which the vectorizer maps onto SIMD
+// registers, then the lanes and the tail.
+template <typename Fold>
+double
+fold_numbers (const std::span<const double> numbers, const double init,
+              Fold fold) noexcept
+{
+  std::array<double, 4> lanes;
+  lanes.fill (init);
+  size_t i{};
+  for (; numbers.size () - i >= lanes.size (); i += lanes.size ())
+    for (size_t lane{}; lane < lanes.size (); ++lane)
+      lanes[lane] = fold (lanes[lane], numbers[i + lane]);
+  double result{ fold (fold (lanes[0], lanes[1]), fold (lanes[2], lanes[3])) };
+  for (; i < numbers.size (); ++i)
+    result = fold (result, numbers[i]);
+  return result;
+}
+
+} // namespace
+
+double
+sum_numbers (const std::span<const double> numbers) noexcept
+{
+  return fold_numbers (numbers, 0.0,
+                       [] (const double lhs, const double rhs) {
+                         return lhs + rhs;
+                       });
+}
+
+double
+min_number (const std::span<const double> numbers) noexcept
+{
+  if (numbers.empty ())
+    return std::numeric_limits<double>::quiet_NaN ();
+  return fold_numbers (numbers, numbers.front (),
+                       [] (const double lhs, const double rhs) {
+                         return rhs < lhs ? rhs : lhs;
+                       });
+}
+
+double
+max_number (const std::span<const double> numbers) noexcept
+{
+  if (numbers.empty ())
+    return std::numeric_limits<double>::quiet_NaN ();
+  return fold_numbers (numbers, numbers.front (),
+                       [] (const double lhs, const double rhs) {
+                         return lhs < rhs ? rhs : lhs;
+                       });
+}
+
+const std::vector<Json> &
+json_number_array::elements () const
+{
+  std::shared_ptr<const std::vector<Json> > cached{ element_cache.load (
+      std::memory_order_acquire) };
+  if (!cached)
+    {
+      std::vector<Json> built;
+      built.reserve (numbers.size ());
+      for (const double number : numbers)
+        built.emplace_back (number);
+      auto shared{ std::make_shared<const std::vector<Json> > (
+          std::move (built)) };
+      // a concurrent caller may have won; its elements are used then
+      if (element_cache.compare_exchange_strong (cached, shared,
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_acquire))
+        cached = std::move (shared);
+    }
+  return *cached;
+}
+
 std::ostream &
 operator<< (std::ostream &os, const Json &json)
 {
@@ -101,15 +859,378 @@ operator>> (std::istream &is, Json &json)
   return is;
 }
 
+static std::size_t
+combine_hash (const std::size_t seed, const std::size_t hash) noexcept
+{
+  return seed ^ (hash + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+// Json{ number }.hash (), so that typed and generic arrays hash alike.
+static std::size_t
+number_hash (const double number) noexcept
+{
+  const std::size_t result{ combine_hash (
+      static_cast<std::size_t> (json_type::number_t),
+      std::hash<double>{}(number == 0.0 ? 0.0 : number)) };
+  return result != 0 ? result : 1;
+}
+
+std::size_t
+Json::hash () const
+{
+  if (shared_value)
+    {
+      const std::size_t cached{ shared_value->hash.load (
+          std::memory_order_relaxed) };
+      if (cached != 0)
+        return cached;
+    }
+
+  const JSONValue &json_value{ data () };
+  std::size_t result{ static_cast<std::size_t> (get_json_element_type ()) };
+  if (const auto *b = std::get_if<bool> (&json_value))
+    result = combine_hash (result, *b);
+  else if (is_json_number ())
+    {
+      // raw and converted numbers hash alike
+      const double d{ to_number () };
+      result = combine_hash (result,
+                             std::hash<double>{}(d == 0.0 ? 0.0 : d));
+    }
+  else if (const auto *str = std::get_if<std::string> (&json_value))
+    result = combine_hash (result, std::hash<std::string>{}(*str));
+  else if (const auto *json_array
+           = std::get_if<std::vector<Json> > (&json_value))
+    {
+      for (const auto &element : *json_array)
+        result = combine_hash (result, element.hash ());
+    }
+  else if (const auto *numbers = std::get_if<json_number_array> (&json_value))
+    {
+      for (const double number : numbers->values ())
+        result = combine_hash (result, number_hash (number));
+    }
+  else if (const auto *json_object
+           = std::get_if<std::unordered_map<std::string, Json> > (
+               &json_value))
+    {
+      // member order is unspecified, so member hashes are summed
+      std::size_t members_hash{};
+      for (const auto &[key, element] : *json_object)
+        members_hash += combine_hash (std::hash<std::string>{}(key),
+                                      element.hash ());
+      result = combine_hash (result, members_hash);
+    }
+
+  if (result == 0)
+    result = 1;
+  if (shared_value)
+    shared_value->hash.store (result, std::memory_order_relaxed);
+  return result;
+}
+
+bool
+operator== (const Json &lhs, const Json &rhs)
+{
+  const JSONValue &left{ lhs.data () };
+  const JSONValue &right{ rhs.data () };
+  if (&left == &right)
+    return true;
+  if (lhs.is_json_number () && rhs.is_json_number ())
+    return lhs.to_number () == rhs.to_number ();
+  if (left.index () != right.index ())
+    {
+      if (!lhs.is_json_array () || !rhs.is_json_array ())
+        return false;
+      // a json_number_array and a std::vector<Json>
+      const bool is_left_typed{ std::holds_alternative<json_number_array> (
+          left) };
+      const auto &numbers{ std::get<json_number_array> (
+                               is_left_typed ? left : right)
+                               .values () };
+      const auto &elements{ std::get<std::vector<Json> > (
+          is_left_typed ? right : left) };
+      return std::ranges::equal (
+          numbers, elements, [] (const double number, const Json &element) {
+            return element.is_json_number ()
+                   && element.to_number () == number;
+          });
+    }
+  if (lhs.shared_value && rhs.shared_value)
+    {
+      const std::size_t left_hash{ lhs.shared_value->hash.load (
+          std::memory_order_relaxed) };
+      const std::size_t right_hash{ rhs.shared_value->hash.load (
+          std::memory_order_relaxed) };
+      if (left_hash != 0 && right_hash != 0 && left_hash != right_hash)
+        return false;
+    }
+
+  if (const auto *json_array = std::get_if<std::vector<Json> > (&left))
+    {
+      const auto &other = std::get<std::vector<Json> > (right);
+      return json_array->size () == other.size ()
+             && std::equal (json_array->begin (), json_array->end (),
+                            other.begin ());
+    }
+  if (const auto *numbers = std::get_if<json_number_array> (&left))
+    return numbers->values ()
+           == std::get<json_number_array> (right).values ();
+  if (const auto *json_object
+      = std::get_if<std::unordered_map<std::string, Json> > (&left))
+    {
+      const auto &other
+          = std::get<std::unordered_map<std::string, Json> > (right);
+      if (json_object->size () != other.size ())
+        return false;
+      for (const auto &[key, element] : *json_object)
+        {
+          const auto found = other.find (key);
+          if (found == other.end () || element != found->second)
+            return false;
+        }
+      return true;
+    }
+  if (const auto *str = std::get_if<std::string> (&left))
+    return *str == std::get<std::string> (right);
+  if (const auto *d = std::get_if<double> (&left))
+    return *d == std::get<double> (right);
+  if (const auto *b = std::get_if<bool> (&left))
+    return *b == std::get<bool> (right);
+  return true;
+}
+
+std::vector<std::string>
+split_json_pointer (std::string_view pointer)
+{
+  std::vector<std::string> tokens;
+  if (pointer.empty ())
+    return tokens;
+  if (pointer[0] != '/')
+    throw std::invalid_argument{ std::format (
+        "Invalid JSON pointer {}: it must start with '/'!", pointer) };
+  size_t pos{ 1 };
+  while (true)
+    {
+      const size_t end{ std::min (pointer.find ('/', pos), pointer.size ()) };
+      std::string token;
+      token.reserve (end - pos);
+      for (size_t i{ pos }; i < end; ++i)
+        {
+          if (pointer[i] != '~')
+            {
+              token += pointer[i];
+              continue;
+            }
+          if (i + 1 == end || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+            throw std::invalid_argument{ std::format (
+                "Invalid escape sequence in JSON pointer {}!", pointer) };
+          token += pointer[++i] == '0' ? '~' : '/';
+        }
+      tokens.push_back (std::move (token));
+      if (end == pointer.size ())
+        break;
+      pos = end + 1;
+    }
+  return tokens;
+}
+
+std::string
+append_json_pointer (std::string_view pointer, std::string_view token)
+{
+  std::string result;
+  result.reserve (pointer.size () + token.size () + 1);
+  result += pointer;
+  result += '/';
+  for (const char ch : token)
+    {
+      if (ch == '~')
+        result += "~0";
+      else if (ch == '/')
+        result += "~1";
+      else
+        result += ch;
+    }
+  return result;
+}
+
+std::optional<size_t>
+json_pointer_index (std::string_view token)
+{
+  if (token.empty () || (token.size () > 1 && token[0] == '0'))
+    return std::nullopt;
+  size_t index{};
+  const auto [ptr, ec] = std::from_chars (token.data (),
+                                          token.data () + token.size (), index);
+  if (ec != std::errc{} || ptr != token.data () + token.size ())
+    return std::nullopt;
+  return index;
+}
+
+template <typename JsonType>
+static JsonType *
+find_json_pointer_impl (JsonType &json, std::string_view pointer)
+{
+  JsonType *current{ &json };
+  for (const std::string &token : split_json_pointer (pointer))
+    {
+      if (auto json_object = current->get_json_value_as_object ())
+        {
+          auto &members = json_object->get ();
+          const auto found = members.find (token);
+          if (found == members.end ())
+            return nullptr;
+          current = &found->second;
+        }
+      else if (auto json_array = current->get_json_value_as_array ())
+        {
+          auto &elements = json_array->get ();
+          const std::optional<size_t> index{ json_pointer_index (token) };
+          if (!index.has_value () || *index >= elements.size ())
+            return nullptr;
+          current = &elements[*index];
+        }
+      else
+        return nullptr;
+    }
+  return current;
+}
+
+const Json *
+find_json_pointer (const Json &json, std::string_view pointer)
+{
+  return find_json_pointer_impl (json, pointer);
+}
+
+Json *
+find_json_pointer (Json &json, std::string_view pointer)
+{
+  return find_json_pointer_impl (json, pointer);
+}
+
+result_type
+parse (std::string_view input, const parse_options &options)
+{
+  return parse_in_context (input, options, nullptr);
+}
+
+result_type
+parser::parse (const std::string_view input)
+{
+  return parse_in_context (input, options, &pool);
+}
+
+void
+parser::recycle (Json &&json)
+{
+  harvest (json);
+}
+
+void
+parser::harvest (Json &json)
+{
+  if (json.is_shared ())
+    return;
+  if (std::holds_alternative<json_number_array> (
+          json.get_json_value_as_variant ()))
+    {
+      std::vector<double> &numbers{
+        json.as<json_number_array> ().mutable_values ()
+      };
+      numbers.clear ();
+      if (numbers.capacity () != 0
+          && pool.number_arrays.size () < max_pooled_containers)
+        pool.number_arrays.push_back (std::move (numbers));
+    }
+  else if (auto json_array = json.get_json_value_as_array ())
+    {
+      std::vector<Json> &elements{ json_array->get () };
+      for (Json &element : elements)
+        harvest (element);
+      elements.clear ();
+      if (elements.capacity () != 0
+          && pool.arrays.size () < max_pooled_containers)
+        pool.arrays.push_back (std::move (elements));
+    }
+  else if (auto json_object = json.get_json_value_as_object ())
+    {
+      std::unordered_map<std::string, Json> &members{ json_object->get () };
+      while (!members.empty ())
+        {
+          auto member{ members.extract (members.begin ()) };
+          harvest (member.mapped ());
+          member.mapped () = Json{};
+          if (pool.members.size () < max_pooled_containers)
+            pool.members.push_back (std::move (member));
+        }
+      if (pool.objects.size () < max_pooled_containers)
+        pool.objects.push_back (std::move (members));
+    }
+  else if (auto str = json.get_json_value_as_string ())
+    {
+      if (str->get ().capacity () > small_string_capacity
+          && pool.strings.size () < max_pooled_containers)
+        pool.strings.push_back (std::move (str->get ()));
+    }
+}
+
+result_type
+parse (std::u8string_view input, const parse_options &options)
+{
+  return parse (std::string_view{ reinterpret_cast<const char *> (input.data ()),
+                                  input.size () },
+                options);
+}
+
+result_type
+parse (std::u16string_view input, const parse_options &options)
+{
+  return parse_transcoded (input, options);
+}
+
+result_type
+parse (std::u32string_view input, const parse_options &options)
+{
+  return parse_transcoded (input, options);
+}
+
 result_type
-parse (const std::string &input)
+parse (std::wstring_view input, const parse_options &options)
+{
+  return parse_transcoded (input, options);
+}
+
+result_type
+parse (std::string_view input)
 {
   size_t pos{};
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  statistics_scope scope{ json_operation::parse };
+  result_type result{ parseValue (input, pos) };
+  scope.finish (pos);
+  return result;
+#else
   return parseValue (input, pos);
+#endif
 }
 
+static result_type parse_value_dispatch (std::string_view str, size_t &pos);
+
 result_type
-parseValue (const std::string &str, size_t &pos)
+parseValue (std::string_view str, size_t &pos)
+{
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  result_type result{ parse_value_dispatch (str, pos) };
+  if (result.result_value.has_value ())
+    record_value (result.result_value->get_json_value_as_variant (), true);
+  return result;
+#else
+  return parse_value_dispatch (str, pos);
+#endif
+}
+
+static result_type
+parse_value_dispatch (std::string_view str, size_t &pos)
 {
   skip_whitespace (str, pos);
 
@@ -118,6 +1239,22 @@ parseValue (const std::string &str, size_t &pos)
       return result_type{ {}, status::fail, "Unexpected end of json data!" };
     }
 
+  if (active_parse_context != nullptr)
+    {
+      if (auto error = active_parse_context->add_value (pos))
+        return limit_failure (std::move (*error));
+      if (str[pos] == '{' || str[pos] == '[')
+        {
+          if (auto error = active_parse_context->enter_nesting (pos))
+            return limit_failure (std::move (*error));
+          parse_context &context{ *active_parse_context };
+          result_type result{ str[pos] == '{' ? parse_json_object (str, pos)
+                                              : parse_json_array (str, pos) };
+          context.leave_nesting ();
+          return result;
+        }
+    }
+
   if (str[pos] == '{')
     return parse_json_object (str, pos);
   if (str[pos] == '[')
@@ -151,9 +1288,12 @@ parseValue (const std::string &str, size_t &pos)
 }
 
 result_type
-parse_json_object (const std::string &str, size_t &pos)
+parse_json_object (std::string_view str, size_t &pos)
 {
-  std::unordered_map<std::string, Json> json_object;
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  depth_scope depth_guard;
+#endif
+  std::unordered_map<std::string, Json> json_object{ take_object () };
   ++pos;
   skip_whitespace (str, pos);
   while (pos < str.size () && str[pos] != '}')
@@ -163,11 +1303,22 @@ parse_json_object (const std::string &str, size_t &pos)
           status::success == success1 && json_value.has_value ()
           && json_value->is_json_string ())
         {
-          std::string key{ std::get<std::string> (
-              json_value.value ().get_json_value_as_variant ()) };
+          std::string key{ std::move (json_value->as<std::string> ()) };
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+          record_string_allocation (key);
+#endif
+
+          if (active_parse_context != nullptr)
+            {
+              if (auto error = active_parse_context->add_allocation (
+                      sizeof (std::pair<const std::string, Json>)
+                          + 2 * sizeof (void *),
+                      pos))
+                return limit_failure (std::move (*error));
+            }
 
           skip_whitespace (str, pos);
-          if (str[pos] != ':')
+          if (pos >= str.size () || str[pos] != ':')
             return result_type{ std::nullopt, status::fail,
                                 "Expected ':' in JSON object!" };
           ++pos;
@@ -176,13 +1327,16 @@ parse_json_object (const std::string &str, size_t &pos)
             {
               throw std::invalid_argument{ error_msg2 };
             }
-          json_object[std::move (key)] = temp_value.value ();
+          insert_member (json_object, std::move (key),
+                         std::move (*temp_value));
 
           skip_whitespace (str, pos);
-          if (str[pos] == ',')
+          if (pos < str.size () && str[pos] == ',')
             ++pos;
           skip_whitespace (str, pos);
         }
+      else
+        return result_type{ std::nullopt, status::fail, error_msg1 };
     }
   if (pos >= str.size () || str[pos] != '}')
     return result_type{ std::nullopt, status::fail,
@@ -193,19 +1347,55 @@ parse_json_object (const std::string &str, size_t &pos)
 }
 
 result_type
-parse_json_array (const std::string &str, size_t &pos)
+parse_json_array (std::string_view str, size_t &pos)
 {
-  std::vector<Json> json_array;
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  depth_scope depth_guard;
+#endif
   ++pos;
   skip_whitespace (str, pos);
+  std::vector<double> numbers;
+  if (active_parse_context != nullptr
+      && active_parse_context->options.typed_numeric_arrays
+      && !active_parse_context->options.lazy_numbers && pos < str.size ()
+      && str[pos] != ']')
+    {
+      numbers = take_number_array ();
+      if (auto result = parse_number_elements (str, pos, numbers))
+        return std::move (*result);
+    }
+
+  // the numbers read before finding other values become the first elements
+  std::vector<Json> json_array{ take_array () };
+  if (!numbers.empty ())
+    {
+      if (auto error = active_parse_context->add_allocation (
+              numbers.size () * (sizeof (Json) - sizeof (double)), pos))
+        return limit_failure (std::move (*error));
+      json_array.reserve (numbers.size ());
+      for (const double number : numbers)
+        {
+          json_array.emplace_back (number);
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+          record_value (json_array.back ().get_json_value_as_variant (),
+                        false);
+#endif
+        }
+    }
   while (pos < str.size () && str[pos] != ']')
     {
+      if (active_parse_context != nullptr)
+        {
+          if (auto error
+              = active_parse_context->add_allocation (sizeof (Json), pos))
+            return limit_failure (std::move (*error));
+        }
       auto [json_value, success, error_msg] = parseValue (str, pos);
       if (success == status::fail)
         throw std::invalid_argument{ error_msg };
-      json_array.push_back (std::move (json_value.value_or (Json (nullptr))));
+      json_array.push_back (std::move (json_value).value_or (Json (nullptr)));
       skip_whitespace (str, pos);
-      if (str[pos] == ',')
+      if (pos < str.size () && str[pos] == ',')
         ++pos;
       skip_whitespace (str, pos);
     }
@@ -213,45 +1403,382 @@ parse_json_array (const std::string &str, size_t &pos)
     return result_type{ std::nullopt, status::fail,
                         "Expected ']' in JSON array!" };
   ++pos;
-  return result_type{ std::make_optional<Json> (json_array), status::success };
+  return result_type{ std::make_optional<Json> (std::move (json_array)),
+                      status::success };
 }
 
 result_type
-parse_json_string (const std::string &str, size_t &pos)
+parse_json_string (std::string_view str, size_t &pos)
 {
-  if (str[pos] != '"')
+  if (pos >= str.size () || str[pos] != '"')
     return result_type{ std::nullopt, status::fail,
                         "Expected '\"' for json string data!" };
   ++pos;
-  std::string result;
-  while (pos < str.size () && str[pos] != '"')
+  const size_t start{ pos };
+  pos = str.find ('"', start);
+  if (pos == std::string_view::npos)
     {
-      result.push_back (str[pos]);
-      ++pos;
+      pos = str.size ();
+      return result_type{ std::nullopt, status::fail,
+                          "Unterminated json string data!" };
     }
-  if (pos >= str.size () || str[pos] != '"')
+  if (active_parse_context != nullptr)
+    {
+      if (auto error = active_parse_context->add_string (pos - start, start))
+        return limit_failure (std::move (*error));
+    }
+  if (active_parse_context != nullptr
+      && active_parse_context->options.validate_utf8
+      && !is_valid_utf8 (str.substr (start, pos - start)))
     return result_type{ std::nullopt, status::fail,
-                        "Unterminated json string data!" };
+                        "Invalid UTF-8 in json string data!" };
+  std::string result{ take_string (str.substr (start, pos - start)) };
   ++pos;
-  return result_type{ std::make_optional<Json> (Json{ result }),
+  return result_type{ std::make_optional<Json> (Json{ std::move (result) }),
                       status::success };
 }
 
 result_type
-parse_json_number (const std::string &str, size_t &pos)
+parse_json_number (std::string_view str, size_t &pos)
 {
   size_t start{ pos };
   if (str[pos] == '-')
     ++pos;
-  while (pos < str.size () && (std::isdigit (str[pos]) || str[pos] == '.'))
+  while (pos < str.size ()
+         && (std::isdigit (str[pos]) || str[pos] == '.' || str[pos] == 'e'
+             || str[pos] == 'E'
+             || ((str[pos] == '+' || str[pos] == '-')
+                 && (str[pos - 1] == 'e' || str[pos - 1] == 'E'))))
     ++pos;
-  return result_type{ std::make_optional<Json> (
-                          Json{ std::stod (str.substr (start, pos - start)) }),
+  if (active_parse_context != nullptr
+      && active_parse_context->options.lazy_numbers)
+    {
+      const std::string_view text{ str.substr (start, pos - start) };
+      if (!is_json_number_text (text))
+        return result_type{ std::nullopt, status::fail,
+                            "Invalid json number!" };
+      return result_type{ std::make_optional<Json> (
+                              Json{ json_raw_number{ std::string{ text } } }),
+                          status::success };
+    }
+  double number{};
+  const auto [ptr, ec] = std::from_chars (str.data () + start,
+                                          str.data () + pos, number);
+  if (ec != std::errc{})
+    return result_type{ std::nullopt, status::fail, "Invalid json number!" };
+  return result_type{ std::make_optional<Json> (Json{ number }),
+                      status::success };
+}
+
+// pos is at the opening quote. Jumps from quote to quote with memchr and
+// only looks back for escaping backslashes when a quote is found.
+static bool
+skip_json_string (std::string_view str, size_t &pos)
+{
+  ++pos;
+  while (pos < str.size ())
+    {
+      const void *quote{ std::memchr (str.data () + pos, '"',
+                                      str.size () - pos) };
+      if (quote == nullptr)
+        break;
+      const size_t end{ static_cast<size_t> (static_cast<const char *> (quote)
+                                             - str.data ()) };
+      size_t backslashes{};
+      while (end - backslashes > pos && str[end - backslashes - 1] == '\\')
+        ++backslashes;
+      pos = end + 1;
+      if (backslashes % 2 == 0)
+        return true;
+    }
+  pos = str.size ();
+  return false;
+}
+
+bool
+skip_json_value (std::string_view str, size_t &pos)
+{
+  static constexpr std::array<unsigned char, 256> structural = [] {
+    std::array<unsigned char, 256> chars{};
+    chars[static_cast<unsigned char> ('"')] = 1;
+    chars[static_cast<unsigned char> ('{')] = 2;
+    chars[static_cast<unsigned char> ('[')] = 2;
+    chars[static_cast<unsigned char> ('}')] = 3;
+    chars[static_cast<unsigned char> (']')] = 3;
+    return chars;
+  }();
+
+  skip_whitespace (str, pos);
+  if (pos >= str.size ())
+    return false;
+  if (str[pos] == '"')
+    return skip_json_string (str, pos);
+  if (str[pos] != '{' && str[pos] != '[')
+    {
+      while (pos < str.size () && !is_whitespace (str[pos]) && str[pos] != ','
+             && str[pos] != '}' && str[pos] != ']')
+        ++pos;
+      return true;
+    }
+
+  size_t depth{};
+  while (pos < str.size ())
+    {
+      switch (structural[static_cast<unsigned char> (str[pos])])
+        {
+        case 1:
+          if (!skip_json_string (str, pos))
+            return false;
+          continue;
+        case 2:
+          ++depth;
+          break;
+        case 3:
+          if (--depth == 0)
+            {
+              ++pos;
+              return true;
+            }
+          break;
+        default:
+          break;
+        }
+      ++pos;
+    }
+  return false;
+}
+
+namespace
+{
+
+struct selection_node
+{
+  std::unordered_map<std::string, selection_node> children;
+  std::vector<const std::string *> pointers; // pointers ending here
+};
+
+class selective_parser
+{
+public:
+  selective_parser (std::string_view str, size_t pointer_count,
+                    std::unordered_map<std::string, Json> &selected)
+      : str{ str }, remaining{ pointer_count }, selected{ selected }
+  {
+  }
+
+  void
+  select (const selection_node &node)
+  {
+    if (!node.pointers.empty ())
+      {
+        auto [json_value, json_status, error_msg] = parseValue (str, pos);
+        if (json_status != status::success || !json_value.has_value ())
+          throw std::invalid_argument{ error_msg };
+        resolve (node, *json_value);
+        return;
+      }
+
+    skip_whitespace (str, pos);
+    if (pos < str.size () && str[pos] == '{')
+      select_members (node);
+    else if (pos < str.size () && str[pos] == '[')
+      select_elements (node);
+    else
+      {
+        skip ();
+        remaining -= count_pointers (node);
+      }
+  }
+
+  bool
+  is_done () const noexcept
+  {
+    return remaining == 0;
+  }
+
+private:
+  // Records the pointers ending at node and, for pointers that continue
+  // below it, the matching values of the already parsed subtree.
+  void
+  resolve (const selection_node &node, const Json &json)
+  {
+    for (const std::string *pointer : node.pointers)
+      {
+        selected.insert_or_assign (*pointer, json);
+        --remaining;
+      }
+    for (const auto &[token, child] : node.children)
+      {
+        const Json *child_json{ nullptr };
+        if (const auto json_object = json.get_json_value_as_object ())
+          {
+            const auto found = json_object->get ().find (token);
+            if (found != json_object->get ().end ())
+              child_json = &found->second;
+          }
+        else if (const auto json_array = json.get_json_value_as_array ())
+          {
+            const std::optional<size_t> index{ json_pointer_index (token) };
+            if (index.has_value () && *index < json_array->get ().size ())
+              child_json = &json_array->get ()[*index];
+          }
+        if (child_json != nullptr)
+          resolve (child, *child_json);
+        else
+          remaining -= count_pointers (child);
+      }
+  }
+
+  static size_t
+  count_pointers (const selection_node &node) noexcept
+  {
+    size_t count{ node.pointers.size () };
+    for (const auto &[token, child] : node.children)
+      count += count_pointers (child);
+    return count;
+  }
+
+  void
+  skip ()
+  {
+    if (!skip_json_value (str, pos))
+      throw std::invalid_argument ("Unterminated json value!");
+  }
+
+  void
+  expect (const char ch, const char *message)
+  {
+    skip_whitespace (str, pos);
+    if (pos >= str.size () || str[pos] != ch)
+      throw std::invalid_argument{ message };
+    ++pos;
+  }
+
+  bool
+  consume_separator (const char close)
+  {
+    skip_whitespace (str, pos);
+    if (pos < str.size () && str[pos] == ',')
+      {
+        ++pos;
+        return true;
+      }
+    if (pos >= str.size () || str[pos] != close)
+      throw std::invalid_argument{ std::format (
+          "Expected ',' or '{}' in json data!", close) };
+    ++pos;
+    return false;
+  }
+
+  void
+  select_members (const selection_node &node)
+  {
+    size_t unresolved{ count_pointers (node) };
+    // a repeated key is skipped: only its first member is selected
+    std::unordered_set<const selection_node *> visited;
+    ++pos;
+    skip_whitespace (str, pos);
+    if (pos < str.size () && str[pos] == '}')
+      {
+        ++pos;
+        remaining -= unresolved;
+        return;
+      }
+    do
+      {
+        skip_whitespace (str, pos);
+        const size_t key_start{ pos + 1 };
+        if (pos >= str.size () || str[pos] != '"'
+            || !skip_json_string (str, pos))
+          throw std::invalid_argument ("Expected json object key!");
+        const std::string_view key{ str.substr (key_start,
+                                                pos - 1 - key_start) };
+        expect (':', "Expected ':' in JSON object!");
+        const auto found = node.children.find (std::string{ key });
+        if (found == node.children.end ()
+            || !visited.insert (&found->second).second)
+          skip ();
+        else
+          {
+            const size_t before{ remaining };
+            select (found->second);
+            unresolved -= before - remaining;
+            if (is_done ())
+              return;
+          }
+      }
+    while (consume_separator ('}'));
+    remaining -= unresolved;
+  }
+
+  void
+  select_elements (const selection_node &node)
+  {
+    size_t unresolved{ count_pointers (node) };
+    ++pos;
+    skip_whitespace (str, pos);
+    if (pos < str.size () && str[pos] == ']')
+      {
+        ++pos;
+        remaining -= unresolved;
+        return;
+      }
+    size_t index{};
+    do
+      {
+        const auto found = node.children.find (std::to_string (index++));
+        if (found == node.children.end ())
+          skip ();
+        else
+          {
+            const size_t before{ remaining };
+            select (found->second);
+            unresolved -= before - remaining;
+            if (is_done ())
+              return;
+          }
+      }
+    while (consume_separator (']'));
+    remaining -= unresolved;
+  }
+
+  std::string_view str;
+  size_t pos{};
+  size_t remaining;
+  std::unordered_map<std::string, Json> &selected;
+};
+
+} // namespace
+
+result_type
+parse_selected (std::string_view input,
+                const std::vector<std::string> &pointers)
+{
+  selection_node root;
+  for (const std::string &pointer : pointers)
+    {
+      selection_node *node{ &root };
+      for (std::string &token : split_json_pointer (pointer))
+        node = &node->children[std::move (token)];
+      node->pointers.push_back (&pointer);
+    }
+
+  std::unordered_map<std::string, Json> selected;
+  try
+    {
+      selective_parser parser{ input, pointers.size (), selected };
+      parser.select (root);
+    }
+  catch (const std::invalid_argument &error)
+    {
+      return result_type{ std::nullopt, status::fail, error.what () };
+    }
+  return result_type{ std::make_optional<Json> (std::move (selected)),
                       status::success };
 }
 
 void
-skip_whitespace (const std::string &str, size_t &pos)
+skip_whitespace (std::string_view str, size_t &pos)
 {
   while (pos < str.size () && is_whitespace (str[pos]))
     ++pos;
@@ -277,11 +1804,47 @@ is_whitespace (char ch)
 void
 print_value (const JSONValue &val, std::ostream &os, int indent, int level)
 {
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  statistics_scope scope{ json_operation::serialize };
+  const std::ostream::pos_type start_position{ os.tellp () };
+  record_value (val, false);
+#endif
   std::visit (
       [&] (const auto &variant_value) {
         print_helper (variant_value, os, indent, level);
       },
       val);
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  const std::ostream::pos_type end_position{ os.tellp () };
+  scope.finish (start_position != std::ostream::pos_type (-1)
+                        && end_position != std::ostream::pos_type (-1)
+                    ? static_cast<size_t> (end_position - start_position)
+                    : 0);
+#endif
+}
+
+void
+print_json (const Json &json, std::ostream &os, int indent, int level)
+{
+  if (!json.shared_value || (!json.is_json_array () && !json.is_json_object ()))
+    {
+      print_value (json.data (), os, indent, level);
+      return;
+    }
+  std::shared_ptr<const Json::serialized_json> serialized{
+    json.shared_value->serialized.load (std::memory_order_acquire)
+  };
+  if (!serialized || serialized->indent != indent
+      || serialized->level != level)
+    {
+      std::ostringstream oss;
+      print_value (json.data (), oss, indent, level);
+      serialized = std::make_shared<const Json::serialized_json> (
+          Json::serialized_json{ indent, level, oss.str () });
+      json.shared_value->serialized.store (serialized,
+                                           std::memory_order_release);
+    }
+  os << serialized->text;
 }
 
 void
@@ -299,6 +1862,12 @@ print_helper (double d, std::ostream &os, int, int)
 {
   os << d;
 }
+void
+print_helper (const json_raw_number &number, std::ostream &os, int, int)
+{
+  os << number.text;
+}
+
 void
 print_helper (const std::string &s, std::ostream &os, int, int)
 {
@@ -309,11 +1878,31 @@ void
 print_helper (const std::vector<Json> &json_array, std::ostream &os,
               int indent, int level)
 {
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  depth_scope depth_guard;
+#endif
   os << '[' << '\n';
   for (const auto &el : json_array)
     {
       os << std::string ((level + 1) * indent, ' ');
-      print_value (el.get_json_value_as_variant (), os, indent, level + 1);
+      print_json (el, os, indent, level + 1);
+      os << ',' << '\n';
+    }
+  os << std::string (level * indent, ' ') << ']';
+}
+
+void
+print_helper (const json_number_array &json_array, std::ostream &os,
+              int indent, int level)
+{
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  depth_scope depth_guard;
+#endif
+  os << '[' << '\n';
+  for (const double number : json_array.values ())
+    {
+      os << std::string ((level + 1) * indent, ' ');
+      print_helper (number, os, indent, level + 1);
       os << ',' << '\n';
     }
   os << std::string (level * indent, ' ') << ']';
@@ -323,13 +1912,15 @@ void
 print_helper (const std::unordered_map<std::string, Json> &json_object,
               std::ostream &os, int indent, int level)
 {
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+  depth_scope depth_guard;
+#endif
   os << '{' << '\n';
   for (const auto &[json_key, json_value] : json_object)
     {
       os << std::string ((level + 1) * indent, ' ') << '"' << json_key << '"'
          << ": ";
-      print_value (json_value.get_json_value_as_variant (), os, indent,
-                   level + 1);
+      print_json (json_value, os, indent, level + 1);
       os << ",\n";
     }
   os << std::string (level * indent, ' ') << '}';
@@ -0,0 +1,186 @@
+#include "../include/simple_json_async.h"
+
+#include <stdexcept>
+
+namespace simple_json
+{
+
+void
+json_stream_splitter::feed (const std::string_view chunk)
+{
+  if (is_finished)
+    throw std::logic_error{ "json_stream_splitter: input already finished" };
+
+  // drop the bytes of the values handed out so far
+  const size_t consumed{ value_start != std::string::npos ? value_start
+                                                          : scan_pos };
+  if (consumed != 0)
+    {
+      buffer.erase (0, consumed);
+      scan_pos -= consumed;
+      if (value_start != std::string::npos)
+        value_start = 0;
+    }
+  buffer.append (chunk);
+}
+
+std::optional<Json>
+json_stream_splitter::next ()
+{
+  if (scan_value ())
+    {
+      Json json = parse_value (scan_pos);
+      value_start = std::string::npos;
+      return json;
+    }
+  if (is_finished && !is_drained)
+    {
+      if (value_start != std::string::npos
+          || (mode == json_stream_mode::array_elements
+              && state != array_state::closed))
+        throw std::invalid_argument{ "Unexpected end of json data!" };
+      is_drained = true;
+    }
+  return std::nullopt;
+}
+
+// Advances scan_pos over the input received so far. Returns true once the
+// value starting at value_start ends at scan_pos.
+bool
+json_stream_splitter::scan_value ()
+{
+  while (value_start == std::string::npos)
+    {
+      skip_whitespace (buffer, scan_pos);
+      if (scan_pos >= buffer.size ())
+        return false;
+
+      const char ch{ buffer[scan_pos] };
+      if (mode == json_stream_mode::array_elements)
+        {
+          switch (state)
+            {
+            case array_state::before_open:
+              if (ch != '[')
+                throw std::invalid_argument{
+                  "Invalid JSON syntax: expected an array!"
+                };
+              state = array_state::expect_first_element;
+              ++scan_pos;
+              continue;
+            case array_state::expect_first_element:
+              if (ch == ']')
+                {
+                  state = array_state::closed;
+                  ++scan_pos;
+                  continue;
+                }
+              break;
+            case array_state::expect_element:
+              break;
+            case array_state::expect_separator:
+              if (ch == ',' || ch == ']')
+                {
+                  state = ch == ',' ? array_state::expect_element
+                                    : array_state::closed;
+                  ++scan_pos;
+                  continue;
+                }
+              throw std::invalid_argument{
+                "Invalid JSON syntax: missing comma between array elements!"
+              };
+            case array_state::closed:
+              throw std::invalid_argument{
+                "Invalid JSON syntax: unexpected data after the array!"
+              };
+            }
+          state = array_state::expect_separator;
+        }
+
+      if (ch == ',' || ch == ']' || ch == '}' || ch == ':')
+        throw std::invalid_argument{ "Invalid json value!" };
+      value_start = scan_pos;
+      if (ch == '{' || ch == '[')
+        depth = 1;
+      else if (ch == '"')
+        is_in_string = true;
+      else
+        depth = 0;
+      if (ch == '{' || ch == '[' || ch == '"')
+        ++scan_pos;
+    }
+
+  if (!is_in_string && depth == 0)
+    {
+      // a scalar ends at whitespace, a delimiter or the end of the input
+      while (scan_pos < buffer.size () && !is_whitespace (buffer[scan_pos])
+             && std::string_view{ ",:[]{}\"" }.find (buffer[scan_pos])
+                    == std::string_view::npos)
+        ++scan_pos;
+      return scan_pos < buffer.size () || is_finished;
+    }
+
+  while (scan_pos < buffer.size ())
+    {
+      if (is_in_string)
+        {
+          const size_t special{ buffer.find_first_of ("\"\\", scan_pos) };
+          if (special == std::string::npos)
+            {
+              scan_pos = buffer.size ();
+              return false;
+            }
+          if (buffer[special] == '\\')
+            {
+              // wait for the escaped character if it is in the next chunk
+              scan_pos = special;
+              if (special + 1 >= buffer.size ())
+                return false;
+              scan_pos += 2;
+              continue;
+            }
+          is_in_string = false;
+          scan_pos = special + 1;
+          if (depth == 0)
+            return true;
+          continue;
+        }
+
+      switch (buffer[scan_pos++])
+        {
+        case '"':
+          is_in_string = true;
+          break;
+        case '{':
+        case '[':
+          ++depth;
+          break;
+        case '}':
+        case ']':
+          if (--depth == 0)
+            return true;
+          break;
+        default:
+          break;
+        }
+    }
+  return false;
+}
+
+Json
+json_stream_splitter::parse_value (const size_t end)
+{
+  const std::string_view text{ std::string_view{ buffer }.substr (
+      value_start, end - value_start) };
+  size_t pos{};
+  auto [json_value, json_status, error_msg] = parseValue (text, pos);
+  if (json_status != status::success || !json_value.has_value ())
+    throw std::invalid_argument{ error_msg };
+  skip_whitespace (text, pos);
+  if (pos != text.size ())
+    throw std::invalid_argument{ "Invalid JSON syntax: unexpected data after "
+                                 "a value!" };
+  return std::move (*json_value);
+}
+
+} // namespace simple_json
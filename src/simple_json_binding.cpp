@@ -0,0 +1,438 @@
+#include "../include/simple_json_binding.h"
+
+#include <cmath>
+
+namespace simple_json
+{
+
+void
+json_reader::skip_whitespace () noexcept
+{
+  while (pos < input.size () && is_whitespace (input[pos]))
+    ++pos;
+}
+
+char
+json_reader::peek ()
+{
+  skip_whitespace ();
+  if (pos >= input.size ())
+    fail ("Unexpected end of json data!");
+  return input[pos];
+}
+
+bool
+json_reader::consume (const char ch)
+{
+  skip_whitespace ();
+  if (pos < input.size () && input[pos] == ch)
+    {
+      ++pos;
+      return true;
+    }
+  return false;
+}
+
+void
+json_reader::expect (const char ch)
+{
+  if (!consume (ch))
+    fail (std::format ("Expected '{}' in json data!", ch).c_str ());
+}
+
+std::string_view
+json_reader::read_key (std::string &scratch)
+{
+  if (peek () != '"')
+    fail ("Expected '\"' for json object key!");
+  const size_t start{ pos + 1 };
+  const size_t end{ input.find_first_of ("\"\\", start) };
+  if (end != std::string_view::npos && input[end] == '"')
+    {
+      pos = end + 1;
+      return input.substr (start, end - start);
+    }
+  read_string (scratch);
+  return scratch;
+}
+
+void
+json_reader::read_string (std::string &out)
+{
+  if (peek () != '"')
+    fail ("Expected '\"' for json string data!");
+  ++pos;
+  out.clear ();
+  while (true)
+    {
+      const size_t end{ input.find_first_of ("\"\\", pos) };
+      if (end == std::string_view::npos)
+        fail ("Unterminated json string data!");
+      out.append (input.data () + pos, end - pos);
+      pos = end + 1;
+      if (input[end] == '"')
+        return;
+      if (pos >= input.size ())
+        fail ("Unterminated json string data!");
+      switch (input[pos++])
+        {
+        case '"':
+          out += '"';
+          break;
+        case '\\':
+          out += '\\';
+          break;
+        case '/':
+          out += '/';
+          break;
+        case 'b':
+          out += '\b';
+          break;
+        case 'f':
+          out += '\f';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u':
+          {
+            if (pos + 4 > input.size ())
+              fail ("Invalid \\u escape sequence in json string!");
+            unsigned code_point{};
+            const auto [ptr, ec] = std::from_chars (
+                input.data () + pos, input.data () + pos + 4, code_point, 16);
+            if (ec != std::errc{} || ptr != input.data () + pos + 4)
+              fail ("Invalid \\u escape sequence in json string!");
+            pos += 4;
+            if (code_point >= 0xD800 && code_point <= 0xDBFF
+                && input.substr (pos, 2) == "\\u" && pos + 6 <= input.size ())
+              {
+                unsigned low{};
+                const auto [low_ptr, low_ec]
+                    = std::from_chars (input.data () + pos + 2,
+                                       input.data () + pos + 6, low, 16);
+                if (low_ec == std::errc{} && low >= 0xDC00 && low <= 0xDFFF)
+                  {
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10)
+                                 + (low - 0xDC00);
+                    pos += 6;
+                  }
+              }
+            if (code_point < 0x80)
+              out += static_cast<char> (code_point);
+            else if (code_point < 0x800)
+              {
+                out += static_cast<char> (0xC0 | (code_point >> 6));
+                out += static_cast<char> (0x80 | (code_point & 0x3F));
+              }
+            else if (code_point < 0x10000)
+              {
+                out += static_cast<char> (0xE0 | (code_point >> 12));
+                out += static_cast<char> (0x80 | ((code_point >> 6) & 0x3F));
+                out += static_cast<char> (0x80 | (code_point & 0x3F));
+              }
+            else
+              {
+                out += static_cast<char> (0xF0 | (code_point >> 18));
+                out += static_cast<char> (0x80 | ((code_point >> 12) & 0x3F));
+                out += static_cast<char> (0x80 | ((code_point >> 6) & 0x3F));
+                out += static_cast<char> (0x80 | (code_point & 0x3F));
+              }
+            break;
+          }
+        default:
+          fail ("Invalid escape sequence in json string!");
+        }
+    }
+}
+
+std::string_view
+json_reader::read_raw_string ()
+{
+  if (peek () != '"')
+    fail ("Expected '\"' for json string data!");
+  const size_t start{ pos + 1 };
+  const size_t end{ input.find ('"', start) };
+  if (end == std::string_view::npos)
+    fail ("Unterminated json string data!");
+  pos = end + 1;
+  return input.substr (start, end - start);
+}
+
+bool
+json_reader::read_boolean ()
+{
+  peek ();
+  if (input.substr (pos, 4) == "true")
+    {
+      pos += 4;
+      return true;
+    }
+  if (input.substr (pos, 5) == "false")
+    {
+      pos += 5;
+      return false;
+    }
+  fail ("Expected json boolean value!");
+}
+
+bool
+json_reader::consume_null ()
+{
+  skip_whitespace ();
+  if (input.substr (pos, 4) == "null")
+    {
+      pos += 4;
+      return true;
+    }
+  return false;
+}
+
+std::string_view
+json_reader::read_number_text ()
+{
+  const char first{ peek () };
+  if (first != '-' && !std::isdigit (static_cast<unsigned char> (first)))
+    fail ("Expected json number value!");
+  const size_t start{ pos++ };
+  while (pos < input.size ()
+         && (std::isdigit (static_cast<unsigned char> (input[pos]))
+             || std::string_view{ ".eE+-" }.find (input[pos])
+                    != std::string_view::npos))
+    ++pos;
+  return input.substr (start, pos - start);
+}
+
+std::string_view
+json_reader::read_raw_value ()
+{
+  skip_whitespace ();
+  const size_t start{ pos };
+  skip_value ();
+  return input.substr (start, pos - start);
+}
+
+// Skips one value with the same grammar read_json_value () accepts, so
+// unbound members cannot hide input that binding a member would reject.
+// Nesting is tracked on a stack instead of recursing.
+void
+json_reader::skip_value ()
+{
+  std::vector<bool> is_object; // one entry per open container
+  while (true)
+    {
+      switch (peek ())
+        {
+        case '{':
+          ++pos;
+          if (consume ('}'))
+            break;
+          is_object.push_back (true);
+          skip_string ();
+          expect (':');
+          continue;
+        case '[':
+          ++pos;
+          if (consume (']'))
+            break;
+          is_object.push_back (false);
+          continue;
+        case '"':
+          skip_string ();
+          break;
+        case 't':
+        case 'f':
+          read_boolean ();
+          break;
+        case 'n':
+          if (!consume_null ())
+            fail ("Invalid json value!");
+          break;
+        default:
+          {
+            const std::string_view text{ read_number_text () };
+            double number;
+            const auto [ptr, ec] = std::from_chars (
+                text.data (), text.data () + text.size (), number);
+            if (ec != std::errc{} || ptr != text.data () + text.size ())
+              fail ("Invalid json number!");
+          }
+        }
+
+      // a value is complete: close the containers it completes, or move
+      // on to the next element
+      while (true)
+        {
+          if (is_object.empty ())
+            return;
+          if (consume (','))
+            {
+              if (is_object.back ())
+                {
+                  skip_string ();
+                  expect (':');
+                }
+              break;
+            }
+          expect (is_object.back () ? '}' : ']');
+          is_object.pop_back ();
+        }
+    }
+}
+
+void
+json_reader::skip_string ()
+{
+  if (peek () != '"')
+    fail ("Expected '\"' for json string data!");
+  for (++pos;;)
+    {
+      const size_t end{ input.find_first_of ("\"\\", pos) };
+      if (end == std::string_view::npos)
+        fail ("Unterminated json string data!");
+      if (input[end] == '"')
+        {
+          pos = end + 1;
+          return;
+        }
+      pos = end + 2; // past the escaped character
+    }
+}
+
+void
+json_reader::expect_end ()
+{
+  skip_whitespace ();
+  if (pos != input.size ())
+    fail ("Unexpected trailing characters after json value!");
+}
+
+void
+json_reader::fail (const char *message) const
+{
+  throw std::invalid_argument{ std::format ("{} (at offset {})", message,
+                                            pos) };
+}
+
+void
+write_json_string (std::string &out, const std::string_view str)
+{
+  static constexpr const char *hex_digits{ "0123456789abcdef" };
+  out += '"';
+  for (const char ch : str)
+    {
+      switch (ch)
+        {
+        case '"':
+          out += "\\\"";
+          break;
+        case '\\':
+          out += "\\\\";
+          break;
+        case '\n':
+          out += "\\n";
+          break;
+        case '\r':
+          out += "\\r";
+          break;
+        case '\t':
+          out += "\\t";
+          break;
+        case '\b':
+          out += "\\b";
+          break;
+        case '\f':
+          out += "\\f";
+          break;
+        default:
+          if (static_cast<unsigned char> (ch) < 0x20)
+            {
+              out += "\\u00";
+              out += hex_digits[(ch >> 4) & 0xF];
+              out += hex_digits[ch & 0xF];
+            }
+          else
+            out += ch;
+        }
+    }
+  out += '"';
+}
+
+void
+write_json_number (std::string &out, const double number)
+{
+  if (!std::isfinite (number))
+    {
+      out += "null";
+      return;
+    }
+  char buffer[32];
+  const auto [ptr, ec] = std::to_chars (buffer, buffer + sizeof buffer,
+                                        number);
+  out.append (buffer, ptr);
+}
+
+void
+write_json (std::string &out, const Json &json)
+{
+  const JSONValue &value{ json.get_json_value_as_variant () };
+  if (const auto *boolean = std::get_if<bool> (&value))
+    out += *boolean ? "true" : "false";
+  else if (const auto *number = std::get_if<double> (&value))
+    write_json_number (out, *number);
+  else if (const auto *raw_number = std::get_if<json_raw_number> (&value))
+    out += raw_number->text;
+  else if (const auto *str = std::get_if<std::string> (&value))
+    {
+      out += '"';
+      out += *str;
+      out += '"';
+    }
+  else if (const auto *numbers = std::get_if<json_number_array> (&value))
+    {
+      out += '[';
+      for (size_t i{}; i < numbers->values ().size (); ++i)
+        {
+          if (i != 0)
+            out += ',';
+          write_json_number (out, numbers->values ()[i]);
+        }
+      out += ']';
+    }
+  else if (const auto *elements = std::get_if<std::vector<Json> > (&value))
+    {
+      out += '[';
+      for (size_t i{}; i < elements->size (); ++i)
+        {
+          if (i != 0)
+            out += ',';
+          write_json (out, (*elements)[i]);
+        }
+      out += ']';
+    }
+  else if (const auto *members
+           = std::get_if<std::unordered_map<std::string, Json> > (&value))
+    {
+      out += '{';
+      bool is_first{ true };
+      for (const auto &[key, element] : *members)
+        {
+          out += is_first ? "\"" : ",\"";
+          is_first = false;
+          out += key;
+          out += "\":";
+          write_json (out, element);
+        }
+      out += '}';
+    }
+  else
+    out += "null";
+}
+
+} // namespace simple_json
@@ -0,0 +1,241 @@
+#include "../include/simple_json_cache.h"
+
+#include <cstring>
+
+namespace simple_json
+{
+
+namespace
+{
+
+constexpr std::uint64_t prime_1{ 0x9E3779B185EBCA87ULL };
+constexpr std::uint64_t prime_2{ 0xC2B2AE3D27D4EB4FULL };
+constexpr std::uint64_t prime_3{ 0x165667B19E3779F9ULL };
+constexpr std::uint64_t prime_4{ 0x85EBCA77C2B2AE63ULL };
+constexpr std::uint64_t prime_5{ 0x27D4EB2F165667C5ULL };
+
+constexpr std::uint64_t
+rotate_left (const std::uint64_t value, const int bits) noexcept
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+std::uint64_t
+load_64 (const char *ptr) noexcept
+{
+  std::uint64_t value;
+  std::memcpy (&value, ptr, sizeof value);
+  return value;
+}
+
+std::uint32_t
+load_32 (const char *ptr) noexcept
+{
+  std::uint32_t value;
+  std::memcpy (&value, ptr, sizeof value);
+  return value;
+}
+
+constexpr std::uint64_t
+hash_round (std::uint64_t accumulator, const std::uint64_t input) noexcept
+{
+  accumulator += input * prime_2;
+  return rotate_left (accumulator, 31) * prime_1;
+}
+
+constexpr std::uint64_t
+merge_round (std::uint64_t accumulator, const std::uint64_t value) noexcept
+{
+  accumulator ^= hash_round (0, value);
+  return accumulator * prime_1 + prime_4;
+}
+
+// Rough heap footprint of a parsed tree, charged against the cache capacity.
+size_t
+approximate_size (const Json &json)
+{
+  size_t size{ sizeof (Json) };
+  if (const auto str = json.get_json_value_as_string ())
+    size += str->get ().capacity ();
+  else if (const auto numbers = json.get_json_value_as_numbers ())
+    size += numbers->size () * sizeof (double);
+  else if (const auto json_array = json.get_json_value_as_array ())
+    {
+      for (const Json &element : json_array->get ())
+        size += approximate_size (element);
+    }
+  else if (const auto json_object = json.get_json_value_as_object ())
+    {
+      size += json_object->get ().bucket_count () * sizeof (void *);
+      for (const auto &[key, element] : json_object->get ())
+        size += sizeof (std::string) + key.capacity () + 2 * sizeof (void *)
+                + approximate_size (element);
+    }
+  return size;
+}
+
+} // namespace
+
+std::uint64_t
+hash_json_input (const std::string_view input) noexcept
+{
+  const char *ptr{ input.data () };
+  const char *const end{ ptr + input.size () };
+  std::uint64_t hash;
+
+  if (input.size () >= 32)
+    {
+      std::uint64_t lane_1{ prime_1 + prime_2 };
+      std::uint64_t lane_2{ prime_2 };
+      std::uint64_t lane_3{ 0 };
+      std::uint64_t lane_4{ 0 - prime_1 };
+      for (const char *const limit{ end - 32 }; ptr <= limit; ptr += 32)
+        {
+          lane_1 = hash_round (lane_1, load_64 (ptr));
+          lane_2 = hash_round (lane_2, load_64 (ptr + 8));
+          lane_3 = hash_round (lane_3, load_64 (ptr + 16));
+          lane_4 = hash_round (lane_4, load_64 (ptr + 24));
+        }
+      hash = rotate_left (lane_1, 1) + rotate_left (lane_2, 7)
+             + rotate_left (lane_3, 12) + rotate_left (lane_4, 18);
+      hash = merge_round (hash, lane_1);
+      hash = merge_round (hash, lane_2);
+      hash = merge_round (hash, lane_3);
+      hash = merge_round (hash, lane_4);
+    }
+  else
+    hash = prime_5;
+
+  hash += input.size ();
+  for (; ptr + 8 <= end; ptr += 8)
+    hash = rotate_left (hash ^ hash_round (0, load_64 (ptr)), 27) * prime_1
+           + prime_4;
+  if (ptr + 4 <= end)
+    {
+      hash = rotate_left (hash ^ (load_32 (ptr) * prime_1), 23) * prime_2
+             + prime_3;
+      ptr += 4;
+    }
+  for (; ptr < end; ++ptr)
+    hash = rotate_left (hash ^ (static_cast<unsigned char> (*ptr) * prime_5),
+                        11)
+           * prime_1;
+
+  hash ^= hash >> 33;
+  hash *= prime_2;
+  hash ^= hash >> 29;
+  hash *= prime_3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+json_parse_cache::json_parse_cache (const size_t capacity_bytes)
+    : capacity_bytes{ capacity_bytes }
+{
+}
+
+frozen_json
+json_parse_cache::parse (const std::string_view input)
+{
+  const std::uint64_t hash{ hash_json_input (input) };
+  {
+    std::lock_guard lock{ mutex };
+    if (const auto found = slot_by_hash.find (hash);
+        found != slot_by_hash.end () && entries[found->second].input == input)
+      {
+        entry &cached{ entries[found->second] };
+        cached.is_referenced = true;
+        hit_count.fetch_add (1, std::memory_order_relaxed);
+        return cached.document;
+      }
+  }
+  miss_count.fetch_add (1, std::memory_order_relaxed);
+
+  auto [json_value, json_status, error_msg] = simple_json::parse (input);
+  if (json_status != status::success || !json_value.has_value ())
+    throw std::invalid_argument{ error_msg };
+  const size_t charge{ input.size () + approximate_size (*json_value) };
+  frozen_json document{ std::move (*json_value) };
+  if (charge <= capacity_bytes)
+    {
+      std::lock_guard lock{ mutex };
+      insert (hash, input, document, charge);
+    }
+  return document;
+}
+
+void
+json_parse_cache::insert (const std::uint64_t hash,
+                          const std::string_view input,
+                          const frozen_json &document, const size_t charge)
+{
+  // another thread may have parsed the same input meanwhile, and inputs
+  // with colliding hashes replace each other
+  if (const auto found = slot_by_hash.find (hash); found != slot_by_hash.end ())
+    evict (found->second);
+
+  while (used_bytes + charge > capacity_bytes)
+    {
+      if (clock_hand >= entries.size ())
+        clock_hand = 0;
+      entry &candidate{ entries[clock_hand] };
+      if (candidate.is_occupied && candidate.is_referenced)
+        candidate.is_referenced = false;
+      else if (candidate.is_occupied)
+        evict (clock_hand);
+      ++clock_hand;
+    }
+
+  size_t slot;
+  if (!free_slots.empty ())
+    {
+      slot = free_slots.back ();
+      free_slots.pop_back ();
+    }
+  else
+    {
+      slot = entries.size ();
+      entries.emplace_back ();
+    }
+  entries[slot] = entry{ std::string{ input }, hash, document, charge, false,
+                         true };
+  slot_by_hash.emplace (hash, slot);
+  used_bytes += charge;
+}
+
+void
+json_parse_cache::evict (const size_t slot)
+{
+  entry &evicted{ entries[slot] };
+  slot_by_hash.erase (evicted.hash);
+  used_bytes -= evicted.charge;
+  evicted = entry{};
+  free_slots.push_back (slot);
+}
+
+void
+json_parse_cache::clear ()
+{
+  std::lock_guard lock{ mutex };
+  entries.clear ();
+  free_slots.clear ();
+  slot_by_hash.clear ();
+  clock_hand = 0;
+  used_bytes = 0;
+}
+
+size_t
+json_parse_cache::size_bytes () const
+{
+  std::lock_guard lock{ mutex };
+  return used_bytes;
+}
+
+size_t
+json_parse_cache::entry_count () const
+{
+  std::lock_guard lock{ mutex };
+  return slot_by_hash.size ();
+}
+
+} // namespace simple_json
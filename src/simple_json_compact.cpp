@@ -0,0 +1,354 @@
+#include "../include/simple_json_compact.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace simple_json
+{
+
+namespace
+{
+
+// Member order: shorter keys first, then bytewise. Most probes are then
+// decided by the length alone.
+bool
+is_key_less (const std::string_view lhs, const std::string_view rhs) noexcept
+{
+  if (lhs.size () != rhs.size ())
+    return lhs.size () < rhs.size ();
+  return lhs < rhs;
+}
+
+} // namespace
+
+struct compact_document::arena
+{
+  std::pmr::monotonic_buffer_resource resource;
+  size_t allocated_bytes{};
+  compact_json root;
+
+  template <typename T>
+  T *
+  allocate (const size_t count)
+  {
+    allocated_bytes += count * sizeof (T);
+    return static_cast<T *> (
+        resource.allocate (count * sizeof (T), alignof (T)));
+  }
+
+  static std::uint32_t
+  checked_size (const size_t size, const char *what)
+  {
+    if (size > std::numeric_limits<std::uint32_t>::max ())
+      throw std::invalid_argument{ std::format (
+          "A compact_json {} is limited to {} entries, got {}!", what,
+          std::numeric_limits<std::uint32_t>::max (), size) };
+    return static_cast<std::uint32_t> (size);
+  }
+
+  void
+  build_string (compact_json &node, const std::string_view str)
+  {
+    if (str.size () <= compact_json::max_short_string)
+      {
+        compact_json::short_string_layout layout{};
+        layout.tag = compact_json::kind::short_string;
+        layout.length = static_cast<std::uint8_t> (str.size ());
+        std::memcpy (layout.chars, str.data (), str.size ());
+        node.storage.short_string = layout;
+        return;
+      }
+    compact_json::node_layout layout{};
+    layout.tag = compact_json::kind::string;
+    layout.size = checked_size (str.size (), "string");
+    char *chars{ allocate<char> (str.size ()) };
+    std::memcpy (chars, str.data (), str.size ());
+    layout.chars = chars;
+    node.storage.node = layout;
+  }
+
+  void
+  build (compact_json &node, const Json &json)
+  {
+    compact_json::node_layout layout{};
+    switch (json.get_json_element_type ())
+      {
+      case json_type::null_t:
+        layout.tag = compact_json::kind::null;
+        break;
+      case json_type::boolean_t:
+        layout.tag = compact_json::kind::boolean;
+        layout.boolean = json.to_bool ();
+        break;
+      case json_type::number_t:
+        layout.tag = compact_json::kind::number;
+        layout.number = json.to_number ();
+        break;
+      case json_type::string_t:
+        build_string (node, json.get_json_value_as_string ()->get ());
+        return;
+      case json_type::array_t:
+        if (const auto numbers = json.get_json_value_as_numbers ())
+          {
+            layout.tag = compact_json::kind::array;
+            layout.size = checked_size (numbers->size (), "array");
+            compact_json *children{ allocate<compact_json> (numbers->size ()) };
+            std::uninitialized_default_construct_n (children, numbers->size ());
+            for (size_t i{}; i < numbers->size (); ++i)
+              {
+                children[i].storage.node.tag = compact_json::kind::number;
+                children[i].storage.node.number = (*numbers)[i];
+              }
+            layout.elements = children;
+            break;
+          }
+        {
+          const std::vector<Json> &elements{
+            json.get_json_value_as_array ()->get ()
+          };
+          layout.tag = compact_json::kind::array;
+          layout.size = checked_size (elements.size (), "array");
+          compact_json *children{ allocate<compact_json> (elements.size ()) };
+          std::uninitialized_default_construct_n (children, elements.size ());
+          for (size_t i{}; i < elements.size (); ++i)
+            build (children[i], elements[i]);
+          layout.elements = children;
+          break;
+        }
+      case json_type::object_t:
+        {
+          const auto &object = json.get_json_value_as_object ()->get ();
+          std::vector<const std::pair<const std::string, Json> *> sorted;
+          sorted.reserve (object.size ());
+          for (const auto &member : object)
+            sorted.push_back (&member);
+          std::ranges::sort (sorted, is_key_less, [] (const auto *member) {
+            return std::string_view{ member->first };
+          });
+
+          layout.tag = compact_json::kind::object;
+          layout.size = checked_size (sorted.size (), "object");
+          compact_member *members{ allocate<compact_member> (sorted.size ()) };
+          std::uninitialized_default_construct_n (members, sorted.size ());
+          for (size_t i{}; i < sorted.size (); ++i)
+            {
+              build_string (members[i].key, sorted[i]->first);
+              build (members[i].value, sorted[i]->second);
+            }
+          layout.members = members;
+          break;
+        }
+      }
+    node.storage.node = layout;
+  }
+};
+
+json_type
+compact_json::get_json_element_type () const noexcept
+{
+  switch (tag ())
+    {
+    case kind::boolean:
+      return json_type::boolean_t;
+    case kind::number:
+      return json_type::number_t;
+    case kind::short_string:
+    case kind::string:
+      return json_type::string_t;
+    case kind::array:
+      return json_type::array_t;
+    case kind::object:
+      return json_type::object_t;
+    default:
+      return json_type::null_t;
+    }
+}
+
+double
+compact_json::to_number () const noexcept
+{
+  return is_json_number () ? storage.node.number
+                           : std::numeric_limits<double>::quiet_NaN ();
+}
+
+std::optional<bool>
+compact_json::get_json_value_as_bool () const noexcept
+{
+  if (is_json_boolean ())
+    return storage.node.boolean;
+  return std::nullopt;
+}
+
+std::optional<double>
+compact_json::get_json_value_as_number () const noexcept
+{
+  if (is_json_number ())
+    return storage.node.number;
+  return std::nullopt;
+}
+
+std::optional<std::string_view>
+compact_json::get_json_value_as_string () const noexcept
+{
+  if (tag () == kind::short_string)
+    return std::string_view{ storage.short_string.chars,
+                             storage.short_string.length };
+  if (tag () == kind::string)
+    return std::string_view{ storage.node.chars, storage.node.size };
+  return std::nullopt;
+}
+
+std::optional<std::span<const compact_json> >
+compact_json::get_json_value_as_array () const noexcept
+{
+  if (is_json_array ())
+    return std::span<const compact_json>{ storage.node.elements,
+                                          storage.node.size };
+  return std::nullopt;
+}
+
+std::optional<std::span<const compact_member> >
+compact_json::get_json_value_as_object () const noexcept
+{
+  if (is_json_object ())
+    return std::span<const compact_member>{ storage.node.members,
+                                            storage.node.size };
+  return std::nullopt;
+}
+
+size_t
+compact_json::size () const noexcept
+{
+  switch (tag ())
+    {
+    case kind::short_string:
+      return storage.short_string.length;
+    case kind::string:
+    case kind::array:
+    case kind::object:
+      return storage.node.size;
+    default:
+      return 0;
+    }
+}
+
+const compact_json *
+compact_json::find (const std::string_view key) const noexcept
+{
+  const auto members = get_json_value_as_object ();
+  if (!members)
+    return nullptr;
+  const auto found = std::ranges::lower_bound (
+      *members, key, is_key_less, [] (const compact_member &member) {
+        return member.key.key_view ();
+      });
+  if (found == members->end () || found->key.key_view () != key)
+    return nullptr;
+  return &found->value;
+}
+
+const compact_json &
+compact_json::get_json_element_if_exists (const std::string_view key) const
+{
+  if (!is_json_object ())
+    throw std::invalid_argument ("JSON element is not a JSON object!");
+  if (const compact_json *value = find (key))
+    return *value;
+  throw std::out_of_range{ std::format (
+      "JSON element with key {} is not found!", key) };
+}
+
+const compact_json &
+compact_json::get_json_element (const std::string_view key) const noexcept
+{
+  static const compact_json null_json;
+  const compact_json *value{ find (key) };
+  return value != nullptr ? *value : null_json;
+}
+
+Json
+compact_json::to_json () const
+{
+  switch (tag ())
+    {
+    case kind::boolean:
+      return Json{ storage.node.boolean };
+    case kind::number:
+      return Json{ storage.node.number };
+    case kind::short_string:
+    case kind::string:
+      return Json{ std::string{ *get_json_value_as_string () } };
+    case kind::array:
+      {
+        std::vector<Json> elements;
+        elements.reserve (storage.node.size);
+        for (const compact_json &element :
+             std::span{ storage.node.elements, storage.node.size })
+          elements.push_back (element.to_json ());
+        return Json{ std::move (elements) };
+      }
+    case kind::object:
+      {
+        std::unordered_map<std::string, Json> members;
+        members.reserve (storage.node.size);
+        for (const compact_member &member :
+             std::span{ storage.node.members, storage.node.size })
+          members.emplace (*member.key.get_json_value_as_string (),
+                           member.value.to_json ());
+        return Json{ std::move (members) };
+      }
+    default:
+      return Json{ nullptr };
+    }
+}
+
+compact_document::compact_document ()
+    : nodes{ std::make_shared<const arena> () }, root_node{ &nodes->root }
+{
+}
+
+compact_document::compact_document (const Json &json)
+{
+  auto building{ std::make_shared<arena> () };
+  building->build (building->root, json);
+  root_node = &building->root;
+  nodes = std::move (building);
+}
+
+size_t
+compact_document::allocated_bytes () const noexcept
+{
+  return nodes->allocated_bytes;
+}
+
+const compact_json *
+find_json_pointer (const compact_json &json, const std::string_view pointer)
+{
+  const compact_json *current{ &json };
+  for (const std::string &token : split_json_pointer (pointer))
+    {
+      if (current->is_json_object ())
+        {
+          current = current->find (token);
+          if (current == nullptr)
+            return nullptr;
+        }
+      else if (const auto elements = current->get_json_value_as_array ())
+        {
+          const std::optional<size_t> index{ json_pointer_index (token) };
+          if (!index.has_value () || *index >= elements->size ())
+            return nullptr;
+          current = &(*elements)[*index];
+        }
+      else
+        return nullptr;
+    }
+  return current;
+}
+
+} // namespace simple_json
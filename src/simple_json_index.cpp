@@ -0,0 +1,199 @@
+#include "../include/simple_json_index.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace simple_json
+{
+
+json_index::json_index (Json &array, const std::string_view pointer)
+    : array{ &array }, tokens{ split_json_pointer (pointer) }
+{
+  if (!array.is_json_array ())
+    throw std::invalid_argument ("JSON element is not a JSON array!");
+  rebuild ();
+}
+
+Json *
+json_index::find (const std::string_view key)
+{
+  const std::optional<size_t> found{ position (key) };
+  return found.has_value () ? &elements ()[*found] : nullptr;
+}
+
+Json *
+json_index::find (const double key)
+{
+  const std::optional<size_t> found{ position (key) };
+  return found.has_value () ? &elements ()[*found] : nullptr;
+}
+
+const Json *
+json_index::find (const std::string_view key) const
+{
+  const std::optional<size_t> found{ position (key) };
+  return found.has_value () ? &elements ()[*found] : nullptr;
+}
+
+const Json *
+json_index::find (const double key) const
+{
+  const std::optional<size_t> found{ position (key) };
+  return found.has_value () ? &elements ()[*found] : nullptr;
+}
+
+std::optional<size_t>
+json_index::position (const std::string_view key) const noexcept
+{
+  const auto found = strings.find (key);
+  if (found == strings.end ())
+    return std::nullopt;
+  return found->second;
+}
+
+std::optional<size_t>
+json_index::position (const double key) const noexcept
+{
+  const auto found = numbers.find (key);
+  if (found == numbers.end ())
+    return std::nullopt;
+  return found->second;
+}
+
+void
+json_index::push_back (Json element)
+{
+  std::vector<Json> &items{ elements () };
+  insert (element, items.size ());
+  items.push_back (std::move (element));
+}
+
+void
+json_index::erase_at (const size_t position)
+{
+  std::vector<Json> &items{ elements () };
+  if (position >= items.size ())
+    throw std::out_of_range{ std::format (
+        "JSON array index {} is out of range!", position) };
+  remove (items[position]);
+  const size_t last{ items.size () - 1 };
+  if (position != last)
+    {
+      remove (items[last]);
+      items[position] = std::move (items[last]);
+      insert (items[position], position);
+    }
+  items.pop_back ();
+}
+
+bool
+json_index::erase (const std::string_view key)
+{
+  const std::optional<size_t> found{ position (key) };
+  if (found.has_value ())
+    erase_at (*found);
+  return found.has_value ();
+}
+
+bool
+json_index::erase (const double key)
+{
+  const std::optional<size_t> found{ position (key) };
+  if (found.has_value ())
+    erase_at (*found);
+  return found.has_value ();
+}
+
+void
+json_index::rebuild ()
+{
+  strings.clear ();
+  numbers.clear ();
+  const std::vector<Json> &items{ std::as_const (*this).elements () };
+  try
+    {
+      for (size_t i{}; i < items.size (); ++i)
+        insert (items[i], i);
+    }
+  catch (...)
+    {
+      strings.clear ();
+      numbers.clear ();
+      throw;
+    }
+}
+
+const Json *
+json_index::key_of (const Json &element) const
+{
+  const Json *current{ &element };
+  for (const std::string &token : tokens)
+    {
+      if (const auto json_object = current->get_json_value_as_object ())
+        {
+          const auto found = json_object->get ().find (token);
+          if (found == json_object->get ().end ())
+            return nullptr;
+          current = &found->second;
+        }
+      else if (const auto json_array = current->get_json_value_as_array ())
+        {
+          const std::optional<size_t> index{ json_pointer_index (token) };
+          if (!index.has_value () || *index >= json_array->get ().size ())
+            return nullptr;
+          current = &json_array->get ()[*index];
+        }
+      else
+        return nullptr;
+    }
+  return current->is_json_string () || current->is_json_number () ? current
+                                                                   : nullptr;
+}
+
+void
+json_index::insert (const Json &element, const size_t position)
+{
+  const Json *key{ key_of (element) };
+  if (key == nullptr)
+    return;
+  if (const auto str = key->get_json_value_as_string ())
+    {
+      if (!strings.try_emplace (str->get (), position).second)
+        throw std::invalid_argument{ std::format (
+            "Duplicate key {} in the JSON index!", str->get ()) };
+      return;
+    }
+  const double number{ key->to_number () };
+  if (std::isnan (number))
+    return;
+  if (!numbers.try_emplace (number, position).second)
+    throw std::invalid_argument{ std::format (
+        "Duplicate key {} in the JSON index!", number) };
+}
+
+void
+json_index::remove (const Json &element)
+{
+  const Json *key{ key_of (element) };
+  if (key == nullptr)
+    return;
+  if (const auto str = key->get_json_value_as_string ())
+    strings.erase (str->get ());
+  else
+    numbers.erase (key->to_number ());
+}
+
+std::vector<Json> &
+json_index::elements ()
+{
+  return array->get_json_value_as_array ()->get ();
+}
+
+const std::vector<Json> &
+json_index::elements () const
+{
+  return std::as_const (*array).get_json_value_as_array ()->get ();
+}
+
+} // namespace simple_json
@@ -0,0 +1,263 @@
+#include "../include/simple_json_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+
+namespace simple_json
+{
+
+namespace
+{
+
+thread_local bool is_pool_thread{};
+
+// Runs one job at a time. The job is cut into chunks that are claimed
+// through an atomic counter by the workers and the submitting thread.
+class thread_pool
+{
+public:
+  thread_pool ()
+  {
+    const size_t thread_count{ std::max (std::thread::hardware_concurrency (),
+                                         1u) };
+    for (size_t i{ 1 }; i < thread_count; ++i)
+      workers.emplace_back ([this] { work (); });
+  }
+
+  ~thread_pool ()
+  {
+    {
+      std::lock_guard lock{ mutex };
+      is_stopping = true;
+    }
+    job_ready.notify_all ();
+    for (std::thread &worker : workers)
+      worker.join ();
+  }
+
+  size_t
+  concurrency () const noexcept
+  {
+    return workers.size () + 1;
+  }
+
+  // Returns false when the pool is busy with another job.
+  bool
+  run (const size_t count, const size_t chunk_size,
+       const std::function<void (size_t, size_t)> &task)
+  {
+    std::unique_lock submit_lock{ submit_mutex, std::try_to_lock };
+    if (!submit_lock.owns_lock ())
+      return false;
+
+    {
+      std::lock_guard lock{ mutex };
+      job_task = &task;
+      job_count = count;
+      job_chunk_size = chunk_size;
+      next_chunk.store (0, std::memory_order_relaxed);
+      error = nullptr;
+      busy_workers = workers.size ();
+      ++generation;
+    }
+    job_ready.notify_all ();
+
+    is_pool_thread = true;
+    run_chunks ();
+    is_pool_thread = false;
+
+    std::unique_lock lock{ mutex };
+    job_done.wait (lock, [this] { return busy_workers == 0; });
+    job_task = nullptr;
+    if (error)
+      std::rethrow_exception (std::exchange (error, nullptr));
+    return true;
+  }
+
+private:
+  void
+  work ()
+  {
+    is_pool_thread = true;
+    size_t seen_generation{};
+    for (;;)
+      {
+        {
+          std::unique_lock lock{ mutex };
+          job_ready.wait (lock, [&] {
+            return is_stopping || generation != seen_generation;
+          });
+          if (is_stopping)
+            return;
+          seen_generation = generation;
+        }
+        run_chunks ();
+        std::lock_guard lock{ mutex };
+        if (--busy_workers == 0)
+          job_done.notify_one ();
+      }
+  }
+
+  void
+  run_chunks ()
+  {
+    for (;;)
+      {
+        const size_t begin{ next_chunk.fetch_add (job_chunk_size,
+                                                  std::memory_order_relaxed) };
+        if (begin >= job_count)
+          return;
+        try
+          {
+            (*job_task) (begin, std::min (begin + job_chunk_size, job_count));
+          }
+        catch (...)
+          {
+            std::lock_guard lock{ mutex };
+            if (!error)
+              error = std::current_exception ();
+            // let the remaining chunks go unclaimed
+            next_chunk.store (job_count, std::memory_order_relaxed);
+          }
+      }
+  }
+
+  std::vector<std::thread> workers;
+  std::mutex submit_mutex;
+  std::mutex mutex;
+  std::condition_variable job_ready;
+  std::condition_variable job_done;
+  const std::function<void (size_t, size_t)> *job_task{};
+  size_t job_count{};
+  size_t job_chunk_size{};
+  std::atomic<size_t> next_chunk{};
+  size_t busy_workers{};
+  size_t generation{};
+  bool is_stopping{};
+  std::exception_ptr error;
+};
+
+thread_pool &
+shared_thread_pool ()
+{
+  static thread_pool pool;
+  return pool;
+}
+
+// Orders the sort keys of parallel_sort_by (), nullptr being a missing key.
+bool
+is_key_less (const Json *lhs, const Json *rhs)
+{
+  if (lhs == nullptr || rhs == nullptr)
+    return lhs == nullptr && rhs != nullptr;
+  const json_type lhs_type{ lhs->get_json_element_type () };
+  const json_type rhs_type{ rhs->get_json_element_type () };
+  if (lhs_type != rhs_type)
+    return lhs_type < rhs_type;
+  switch (lhs_type)
+    {
+    case json_type::boolean_t:
+      return !lhs->to_bool () && rhs->to_bool ();
+    case json_type::number_t:
+      return lhs->to_number () < rhs->to_number ();
+    case json_type::string_t:
+      return lhs->get_json_value_as_string ()->get ()
+             < rhs->get_json_value_as_string ()->get ();
+    default:
+      return false;
+    }
+}
+
+} // namespace
+
+void
+parallel_for_chunks (const size_t count, const size_t min_chunk_size,
+                     const std::function<void (size_t, size_t)> &task)
+{
+  if (count == 0)
+    return;
+  thread_pool &pool{ shared_thread_pool () };
+  // a few chunks per thread so that a slow chunk does not stall the rest
+  const size_t chunk_size{ std::max (
+      { min_chunk_size, count / (4 * pool.concurrency ()), size_t{ 1 } }) };
+  if (count <= chunk_size || is_pool_thread
+      || !pool.run (count, chunk_size, task))
+    task (0, count);
+}
+
+size_t
+parallel_concurrency () noexcept
+{
+  return shared_thread_pool ().concurrency ();
+}
+
+void
+parallel_sort_by (Json &json, const std::string_view json_pointer)
+{
+  std::vector<Json> &elements{ parallel_helpers::elements_of (json) };
+  split_json_pointer (json_pointer); // reject malformed pointers up front
+
+  struct sort_entry
+  {
+    const Json *key;
+    size_t index;
+  };
+
+  std::vector<sort_entry> entries (elements.size ());
+  std::vector<size_t> run_ends;
+  std::mutex run_ends_mutex;
+  parallel_for_chunks (
+      elements.size (), parallel_min_chunk_size,
+      [&] (const size_t begin, const size_t end) {
+        for (size_t i{ begin }; i < end; ++i)
+          entries[i] = { find_json_pointer (
+                             std::as_const (elements[i]), json_pointer),
+                         i };
+        std::stable_sort (entries.begin () + begin, entries.begin () + end,
+                          [] (const sort_entry &lhs, const sort_entry &rhs) {
+                            return is_key_less (lhs.key, rhs.key);
+                          });
+        std::lock_guard lock{ run_ends_mutex };
+        run_ends.push_back (end);
+      });
+  std::ranges::sort (run_ends);
+
+  // merge neighbouring sorted runs pairwise until one run is left
+  while (run_ends.size () > 1)
+    {
+      const size_t pair_count{ run_ends.size () / 2 };
+      parallel_for_chunks (pair_count, 1, [&] (const size_t begin,
+                                               const size_t end) {
+        for (size_t pair{ begin }; pair < end; ++pair)
+          {
+            const size_t first{ pair == 0 ? 0 : run_ends[2 * pair - 1] };
+            std::inplace_merge (
+                entries.begin () + first,
+                entries.begin () + run_ends[2 * pair],
+                entries.begin () + run_ends[2 * pair + 1],
+                [] (const sort_entry &lhs, const sort_entry &rhs) {
+                  return is_key_less (lhs.key, rhs.key);
+                });
+          }
+      });
+      std::vector<size_t> merged_ends;
+      for (size_t i{ 1 }; i < run_ends.size (); i += 2)
+        merged_ends.push_back (run_ends[i]);
+      if (run_ends.size () % 2 != 0)
+        merged_ends.push_back (run_ends.back ());
+      run_ends = std::move (merged_ends);
+    }
+
+  std::vector<Json> sorted (elements.size ());
+  parallel_for_chunks (elements.size (), parallel_min_chunk_size,
+                       [&] (const size_t begin, const size_t end) {
+                         for (size_t i{ begin }; i < end; ++i)
+                           sorted[i] = std::move (elements[entries[i].index]);
+                       });
+  elements = std::move (sorted);
+}
+
+} // namespace simple_json
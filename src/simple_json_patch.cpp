@@ -0,0 +1,609 @@
+#include "../include/simple_json_patch.h"
+#include "../include/simple_json_binding.h"
+#include "../include/simple_json_literal.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+namespace simple_json
+{
+
+namespace
+{
+
+constexpr std::array<std::string_view, 6> patch_op_names{
+  "add", "remove", "replace", "move", "copy", "test"
+};
+
+enum class edit_kind : unsigned char
+{
+  keep,
+  remove,
+  insert
+};
+
+// Myers' shortest edit script between two sequences of length n and m, with
+// the linear space refinement: the middle snake of an optimal path is found
+// by searching from both ends at once, then the two halves on either side of
+// it are solved recursively. Memory is O(N + M) rather than O(D^2).
+template <typename Equal> class edit_script_builder
+{
+public:
+  edit_script_builder (const ptrdiff_t n, const ptrdiff_t m, Equal equal)
+      : equal{ equal }, offset{ (n + m + 1) / 2 + 1 },
+        forward (2 * static_cast<size_t> (offset) + 1),
+        backward (2 * static_cast<size_t> (offset) + 1)
+  {
+    script.reserve (static_cast<size_t> (n + m));
+    build (0, n, 0, m);
+  }
+
+  std::vector<edit_kind> script;
+
+private:
+  void
+  build (ptrdiff_t x_begin, ptrdiff_t x_end, ptrdiff_t y_begin,
+         ptrdiff_t y_end)
+  {
+    for (; x_begin < x_end && y_begin < y_end && equal (x_begin, y_begin);
+         ++x_begin, ++y_begin)
+      script.push_back (edit_kind::keep);
+    ptrdiff_t suffix{};
+    for (; x_begin < x_end && y_begin < y_end
+           && equal (x_end - 1, y_end - 1);
+         --x_end, --y_end)
+      ++suffix;
+
+    if (x_begin == x_end)
+      script.insert (script.end (), static_cast<size_t> (y_end - y_begin),
+                     edit_kind::insert);
+    else if (y_begin == y_end)
+      script.insert (script.end (), static_cast<size_t> (x_end - x_begin),
+                     edit_kind::remove);
+    else
+      {
+        // Both ends are trimmed, so the split point is strictly inside.
+        const auto [x, y] = middle (x_begin, x_end - x_begin, y_begin,
+                                    y_end - y_begin);
+        build (x_begin, x, y_begin, y);
+        build (x, x_end, y, y_end);
+      }
+    script.insert (script.end (), static_cast<size_t> (suffix),
+                   edit_kind::keep);
+  }
+
+  // A point on an optimal path through the n by m box at (x_begin, y_begin).
+  // forward[k] is the furthest x reached on diagonal k = x - y from the top
+  // left, backward[k] the same from the bottom right with both sequences
+  // reversed, where diagonal k matches forward diagonal n - m - k.
+  std::pair<ptrdiff_t, ptrdiff_t>
+  middle (const ptrdiff_t x_begin, const ptrdiff_t n, const ptrdiff_t y_begin,
+          const ptrdiff_t m)
+  {
+    const ptrdiff_t delta{ n - m };
+    const bool is_odd{ (delta & 1) != 0 };
+    const auto at = [this] (std::vector<ptrdiff_t> &furthest,
+                            const ptrdiff_t k) -> ptrdiff_t & {
+      return furthest[static_cast<size_t> (offset + k)];
+    };
+    const auto advance
+        = [&] (std::vector<ptrdiff_t> &furthest, const ptrdiff_t d,
+               const ptrdiff_t k) {
+            return k == -d
+                           || (k != d
+                               && at (furthest, k - 1) < at (furthest, k + 1))
+                       ? at (furthest, k + 1)
+                       : at (furthest, k - 1) + 1;
+          };
+    at (forward, 1) = 0;
+    at (backward, 1) = 0;
+    for (ptrdiff_t d{}; d <= (n + m + 1) / 2; ++d)
+      {
+        for (ptrdiff_t k{ -d }; k <= d; k += 2)
+          {
+            ptrdiff_t x{ advance (forward, d, k) };
+            ptrdiff_t y{ x - k };
+            for (; x < n && y < m && equal (x_begin + x, y_begin + y); ++x, ++y)
+              ;
+            at (forward, k) = x;
+            const ptrdiff_t reverse_k{ delta - k };
+            if (is_odd && reverse_k >= 1 - d && reverse_k <= d - 1
+                && x + at (backward, reverse_k) >= n)
+              return { x_begin + x, y_begin + y };
+          }
+        for (ptrdiff_t k{ -d }; k <= d; k += 2)
+          {
+            ptrdiff_t x{ advance (backward, d, k) };
+            ptrdiff_t y{ x - k };
+            for (; x < n && y < m
+                   && equal (x_begin + n - 1 - x, y_begin + m - 1 - y);
+                 ++x, ++y)
+              ;
+            at (backward, k) = x;
+            const ptrdiff_t forward_k{ delta - k };
+            if (!is_odd && forward_k >= -d && forward_k <= d
+                && at (forward, forward_k) + x >= n)
+              {
+                const ptrdiff_t forward_x{ at (forward, forward_k) };
+                return { x_begin + forward_x, y_begin + forward_x - forward_k };
+              }
+          }
+      }
+    return { x_begin + n, y_begin + m }; // unreachable, the paths must meet
+  }
+
+  Equal equal;
+  ptrdiff_t offset;
+  std::vector<ptrdiff_t> forward;
+  std::vector<ptrdiff_t> backward;
+};
+
+template <typename Equal>
+std::vector<edit_kind>
+shortest_edit_script (const ptrdiff_t n, const ptrdiff_t m, Equal equal)
+{
+  return std::move (edit_script_builder<Equal>{ n, m, equal }.script);
+}
+
+void diff_values (const Json &source, const Json &target,
+                  const std::string &path, json_patch &patch);
+
+void
+diff_objects (const std::unordered_map<std::string, Json> &source,
+              const std::unordered_map<std::string, Json> &target,
+              const std::string &path, json_patch &patch)
+{
+  for (const auto &[key, element] : source)
+    {
+      const auto found = target.find (key);
+      if (found == target.end ())
+        patch.push_back (json_patch_operation{
+            json_patch_op::remove, append_json_pointer (path, key) });
+      else
+        diff_values (element, found->second, append_json_pointer (path, key),
+                     patch);
+    }
+  for (const auto &[key, element] : target)
+    if (!source.contains (key))
+      patch.push_back (json_patch_operation{ json_patch_op::add,
+                                             append_json_pointer (path, key),
+                                             {},
+                                             element });
+}
+
+void
+diff_arrays (const std::vector<Json> &source, const std::vector<Json> &target,
+             const std::string &path, json_patch &patch)
+{
+  size_t prefix{};
+  const size_t common{ std::min (source.size (), target.size ()) };
+  while (prefix < common && source[prefix] == target[prefix])
+    ++prefix;
+  size_t suffix{};
+  while (suffix < common - prefix
+         && source[source.size () - 1 - suffix]
+                == target[target.size () - 1 - suffix])
+    ++suffix;
+
+  const size_t source_count{ source.size () - prefix - suffix };
+  const size_t target_count{ target.size () - prefix - suffix };
+  std::vector<size_t> source_hashes (source_count);
+  std::vector<size_t> target_hashes (target_count);
+  for (size_t i{}; i < source_count; ++i)
+    source_hashes[i] = source[prefix + i].hash ();
+  for (size_t i{}; i < target_count; ++i)
+    target_hashes[i] = target[prefix + i].hash ();
+
+  const std::vector<edit_kind> script{ shortest_edit_script (
+      static_cast<ptrdiff_t> (source_count),
+      static_cast<ptrdiff_t> (target_count),
+      [&] (const ptrdiff_t x, const ptrdiff_t y) {
+        return source_hashes[x] == target_hashes[y]
+               && source[prefix + x] == target[prefix + y];
+      }) };
+
+  // Runs of removals and insertions between kept elements are paired up and
+  // diffed in place, so an element that only changed a little yields a
+  // nested patch instead of a remove / add pair.
+  size_t position{ prefix };
+  size_t source_index{ prefix };
+  size_t target_index{ prefix };
+  size_t removed{};
+  size_t inserted{};
+  const auto flush = [&] {
+    const size_t paired{ std::min (removed, inserted) };
+    for (size_t i{}; i < paired; ++i)
+      diff_values (source[source_index - removed + i],
+                   target[target_index - inserted + i],
+                   append_json_pointer (path, std::to_string (position + i)),
+                   patch);
+    for (size_t i{ paired }; i < removed; ++i)
+      patch.push_back (json_patch_operation{
+          json_patch_op::remove,
+          append_json_pointer (path, std::to_string (position + paired)) });
+    for (size_t i{ paired }; i < inserted; ++i)
+      patch.push_back (json_patch_operation{
+          json_patch_op::add,
+          append_json_pointer (path, std::to_string (position + i)),
+          {},
+          target[target_index - inserted + i] });
+    position += inserted;
+    removed = inserted = 0;
+  };
+  for (const edit_kind edit : script)
+    {
+      if (edit == edit_kind::remove)
+        {
+          ++removed;
+          ++source_index;
+          continue;
+        }
+      if (edit == edit_kind::insert)
+        {
+          ++inserted;
+          ++target_index;
+          continue;
+        }
+      flush ();
+      ++position;
+      ++source_index;
+      ++target_index;
+    }
+  flush ();
+}
+
+void
+diff_values (const Json &source, const Json &target, const std::string &path,
+             json_patch &patch)
+{
+  const auto source_object = source.get_json_value_as_object ();
+  const auto target_object = target.get_json_value_as_object ();
+  if (source_object.has_value () && target_object.has_value ())
+    return diff_objects (source_object->get (), target_object->get (), path,
+                         patch);
+  const auto source_array = source.get_json_value_as_array ();
+  const auto target_array = target.get_json_value_as_array ();
+  if (source_array.has_value () && target_array.has_value ())
+    return diff_arrays (source_array->get (), target_array->get (), path,
+                        patch);
+  if (source != target)
+    patch.push_back (
+        json_patch_operation{ json_patch_op::replace, path, {}, target });
+}
+
+[[noreturn]] void
+fail_operation (const json_patch_operation &operation, const char *reason)
+{
+  throw std::invalid_argument{ std::format (
+      "JSON patch operation {} {} failed: {}",
+      patch_op_names[static_cast<size_t> (operation.op)], operation.path,
+      reason) };
+}
+
+// Returns the container holding the value path refers to and the path's
+// last (unescaped) reference token.
+std::pair<Json *, std::string>
+resolve_parent (Json &document, const std::string &path,
+                const json_patch_operation &operation)
+{
+  std::vector<std::string> tokens{ split_json_pointer (path) };
+  Json *parent{ find_json_pointer (
+      document, std::string_view{ path }.substr (0, path.rfind ('/'))) };
+  if (parent == nullptr)
+    fail_operation (operation, "parent of the target location does not exist!");
+  return { parent, std::move (tokens.back ()) };
+}
+
+void
+add_value (Json &document, const std::string &path, Json value,
+           const json_patch_operation &operation)
+{
+  if (path.empty ())
+    {
+      document = std::move (value);
+      return;
+    }
+  auto [parent, token] = resolve_parent (document, path, operation);
+  if (auto json_object = parent->get_json_value_as_object ())
+    {
+      json_object->get ().insert_or_assign (std::move (token),
+                                            std::move (value));
+      return;
+    }
+  auto json_array = parent->get_json_value_as_array ();
+  if (!json_array.has_value ())
+    fail_operation (operation, "target location is not inside a container!");
+  std::vector<Json> &elements{ json_array->get () };
+  if (token == "-")
+    {
+      elements.push_back (std::move (value));
+      return;
+    }
+  const std::optional<size_t> index{ json_pointer_index (token) };
+  if (!index.has_value () || *index > elements.size ())
+    fail_operation (operation, "array index is out of range!");
+  elements.insert (elements.begin () + static_cast<ptrdiff_t> (*index),
+                   std::move (value));
+}
+
+Json
+remove_value (Json &document, const std::string &path,
+              const json_patch_operation &operation)
+{
+  if (path.empty ())
+    fail_operation (operation, "the document root cannot be removed!");
+  auto [parent, token] = resolve_parent (document, path, operation);
+  if (auto json_object = parent->get_json_value_as_object ())
+    {
+      auto node = json_object->get ().extract (token);
+      if (node.empty ())
+        fail_operation (operation, "target location does not exist!");
+      return std::move (node.mapped ());
+    }
+  auto json_array = parent->get_json_value_as_array ();
+  const std::optional<size_t> index{ json_pointer_index (token) };
+  if (!json_array.has_value () || !index.has_value ()
+      || *index >= json_array->get ().size ())
+    fail_operation (operation, "target location does not exist!");
+  std::vector<Json> &elements{ json_array->get () };
+  Json removed = std::move (elements[*index]);
+  elements.erase (elements.begin () + static_cast<ptrdiff_t> (*index));
+  return removed;
+}
+
+void
+apply_operation (Json &document, const json_patch_operation &operation)
+{
+  switch (operation.op)
+    {
+    case json_patch_op::add:
+      add_value (document, operation.path, operation.value, operation);
+      break;
+    case json_patch_op::remove:
+      remove_value (document, operation.path, operation);
+      break;
+    case json_patch_op::replace:
+      {
+        Json *target{ find_json_pointer (document, operation.path) };
+        if (target == nullptr)
+          fail_operation (operation, "target location does not exist!");
+        *target = operation.value;
+        break;
+      }
+    case json_patch_op::move:
+      {
+        if (operation.from == operation.path)
+          break;
+        if (operation.path.starts_with (operation.from + '/'))
+          fail_operation (operation,
+                          "a value cannot be moved into one of its children!");
+        Json value = remove_value (document, operation.from, operation);
+        add_value (document, operation.path, std::move (value), operation);
+        break;
+      }
+    case json_patch_op::copy:
+      {
+        const Json *source{ find_json_pointer (std::as_const (document),
+                                               operation.from) };
+        if (source == nullptr)
+          fail_operation (operation, "from location does not exist!");
+        Json value = *source;
+        add_value (document, operation.path, std::move (value), operation);
+        break;
+      }
+    case json_patch_op::test:
+      {
+        const Json *target{ find_json_pointer (std::as_const (document),
+                                               operation.path) };
+        if (target == nullptr || *target != operation.value)
+          fail_operation (operation, "test failed!");
+        break;
+      }
+    }
+}
+
+const Json &
+required_member (const Json &json, const std::string &key)
+{
+  if (!json.get_json_value_as_object ().value ().get ().contains (key))
+    throw std::invalid_argument{ std::format (
+        "JSON patch operation is missing member {}!", key) };
+  return json.at (key);
+}
+
+const std::string &
+required_string_member (const Json &json, const std::string &key)
+{
+  const auto str = required_member (json, key).get_json_value_as_string ();
+  if (!str.has_value ())
+    throw std::invalid_argument{ std::format (
+        "JSON patch operation member {} must be a string!", key) };
+  return str->get ();
+}
+
+std::unordered_map<std::string, Json> &
+make_object (Json &target)
+{
+  if (!target.is_json_object ())
+    target = Json{ std::unordered_map<std::string, Json>{} };
+  return target.get_json_value_as_object ()->get ();
+}
+
+void
+merge_patch_from_reader (Json &target, json_reader &reader)
+{
+  if (reader.peek () != '{')
+    {
+      read_json_value (reader, target);
+      return;
+    }
+  reader.expect ('{');
+  std::unordered_map<std::string, Json> &members{ make_object (target) };
+  if (reader.consume ('}'))
+    return;
+  do
+    {
+      // raw, as parse () stores keys, so that the members match
+      std::string key{ reader.read_raw_string () };
+      reader.expect (':');
+      if (reader.consume_null ())
+        members.erase (key);
+      else if (reader.peek () == '{')
+        merge_patch_from_reader (members[std::move (key)], reader);
+      else
+        read_json_value (reader, members[std::move (key)]);
+    }
+  while (reader.consume (','));
+  reader.expect ('}');
+}
+
+} // namespace
+
+void
+merge_patch (Json &target, const Json &patch)
+{
+  const auto patch_object = patch.get_json_value_as_object ();
+  if (!patch_object.has_value ())
+    {
+      target = patch;
+      return;
+    }
+  std::unordered_map<std::string, Json> &members{ make_object (target) };
+  for (const auto &[key, value] : patch_object->get ())
+    {
+      if (value.is_json_null ())
+        members.erase (key);
+      else
+        merge_patch (members[key], value);
+    }
+}
+
+void
+merge_patch (Json &target, Json &&patch)
+{
+  if (!patch.is_json_object ())
+    {
+      target = std::move (patch);
+      return;
+    }
+  std::unordered_map<std::string, Json> &members{ make_object (target) };
+  std::unordered_map<std::string, Json> &patch_members{
+    patch.get_json_value_as_object ()->get ()
+  };
+  while (!patch_members.empty ())
+    {
+      auto node = patch_members.extract (patch_members.begin ());
+      if (node.mapped ().is_json_null ())
+        {
+          members.erase (node.key ());
+          continue;
+        }
+      const auto found = members.find (node.key ());
+      if (found != members.end ())
+        {
+          merge_patch (found->second, std::move (node.mapped ()));
+          continue;
+        }
+      // Objects merged into a missing member still need their nulls
+      // stripped, everything else is spliced as is.
+      if (node.mapped ().is_json_object ())
+        {
+          Json merged{ std::unordered_map<std::string, Json>{} };
+          merge_patch (merged, std::move (node.mapped ()));
+          node.mapped () = std::move (merged);
+        }
+      members.insert (std::move (node));
+    }
+}
+
+void
+merge_patch_from_string (Json &target, const std::string_view patch)
+{
+  if (!is_valid_json (patch))
+    throw std::invalid_argument ("Invalid JSON merge patch!");
+  json_reader reader{ patch };
+  merge_patch_from_reader (target, reader);
+  reader.expect_end ();
+}
+
+json_patch
+diff (const Json &source, const Json &target)
+{
+  json_patch patch;
+  diff_values (source, target, std::string{}, patch);
+  return patch;
+}
+
+void
+apply_patch (Json &document, const json_patch &patch)
+{
+  // Sharing makes the copy O(1); applying the patch then only copies the
+  // nodes on the paths it touches.
+  Json result = document.share ();
+  for (const json_patch_operation &operation : patch)
+    apply_operation (result, operation);
+  document = std::move (result);
+}
+
+Json
+json_patch_to_json (const json_patch &patch)
+{
+  std::vector<Json> operations;
+  operations.reserve (patch.size ());
+  for (const json_patch_operation &operation : patch)
+    {
+      std::unordered_map<std::string, Json> members;
+      members.emplace ("op", Json{ std::string{ patch_op_names[static_cast<size_t> (
+                                 operation.op)] } });
+      members.emplace ("path", Json{ operation.path });
+      if (operation.op == json_patch_op::move
+          || operation.op == json_patch_op::copy)
+        members.emplace ("from", Json{ operation.from });
+      if (operation.op == json_patch_op::add
+          || operation.op == json_patch_op::replace
+          || operation.op == json_patch_op::test)
+        members.emplace ("value", operation.value);
+      operations.emplace_back (std::move (members));
+    }
+  return Json{ std::move (operations) };
+}
+
+json_patch
+json_patch_from_json (const Json &json)
+{
+  const auto operations = json.get_json_value_as_array ();
+  if (!operations.has_value ())
+    throw std::invalid_argument ("JSON patch must be a JSON array!");
+  json_patch patch;
+  patch.reserve (operations->get ().size ());
+  for (const Json &element : operations->get ())
+    {
+      if (!element.is_json_object ())
+        throw std::invalid_argument (
+            "JSON patch operation must be a JSON object!");
+      const std::string &name{ required_string_member (element, "op") };
+      const auto found
+          = std::find (patch_op_names.begin (), patch_op_names.end (), name);
+      if (found == patch_op_names.end ())
+        throw std::invalid_argument{ std::format (
+            "Unknown JSON patch operation {}!", name) };
+      json_patch_operation operation{
+        static_cast<json_patch_op> (found - patch_op_names.begin ()),
+        required_string_member (element, "path")
+      };
+      if (operation.op == json_patch_op::move
+          || operation.op == json_patch_op::copy)
+        operation.from = required_string_member (element, "from");
+      if (operation.op == json_patch_op::add
+          || operation.op == json_patch_op::replace
+          || operation.op == json_patch_op::test)
+        operation.value = required_member (element, "value");
+      patch.push_back (std::move (operation));
+    }
+  return patch;
+}
+
+} // namespace simple_json
@@ -0,0 +1,905 @@
+#include "../include/simple_json_path.h"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <utility>
+
+namespace simple_json
+{
+
+namespace
+{
+
+// RFC 9535 restricts indices to the I-JSON range.
+constexpr std::int64_t max_index{ (std::int64_t{ 1 } << 53) - 1 };
+
+[[noreturn]] void
+fail (const std::string_view message, const size_t pos)
+{
+  throw std::invalid_argument{ std::format ("{} at offset {}!", message,
+                                            pos) };
+}
+
+bool
+is_blank (const char ch) noexcept
+{
+  return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+bool
+is_digit (const char ch) noexcept
+{
+  return ch >= '0' && ch <= '9';
+}
+
+bool
+is_name_first (const char ch) noexcept
+{
+  return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_'
+         || static_cast<unsigned char> (ch) >= 0x80;
+}
+
+bool
+is_function_char (const char ch) noexcept
+{
+  return (ch >= 'a' && ch <= 'z') || ch == '_' || is_digit (ch);
+}
+
+size_t
+code_point_count (const std::string_view str) noexcept
+{
+  return static_cast<size_t> (std::count_if (
+      str.begin (), str.end (), [] (const char ch) {
+        return (static_cast<unsigned char> (ch) & 0xC0) != 0x80;
+      }));
+}
+
+// Elements of an array or members of an object, without building the
+// element cache of a json_number_array.
+std::optional<size_t>
+container_size (const Json &json)
+{
+  if (const auto numbers = json.get_json_value_as_numbers ())
+    return numbers->size ();
+  if (const auto json_array = json.get_json_value_as_array ())
+    return json_array->get ().size ();
+  if (const auto json_object = json.get_json_value_as_object ())
+    return json_object->get ().size ();
+  return std::nullopt;
+}
+
+std::optional<std::regex>
+compile_pattern (const std::string &pattern)
+{
+  try
+    {
+      return std::regex{ pattern };
+    }
+  catch (const std::regex_error &)
+    {
+      return std::nullopt;
+    }
+}
+
+} // namespace
+
+class json_path::compiler
+{
+public:
+  compiler (json_path &path, const std::string_view input)
+      : path{ path }, input{ input }
+  {
+  }
+
+  void
+  compile ()
+  {
+    if (pos >= input.size () || input[pos] != '$')
+      fail ("Expected '$' at the start of a JSONPath query", pos);
+    ++pos;
+    path.queries.emplace_back ();
+    parse_segments (main_query);
+    if (pos != input.size ())
+      fail ("Unexpected data after the JSONPath query", pos);
+  }
+
+private:
+  char
+  peek () const noexcept
+  {
+    return pos < input.size () ? input[pos] : '\0';
+  }
+
+  bool
+  starts_with (const std::string_view token) const noexcept
+  {
+    return input.substr (pos).starts_with (token);
+  }
+
+  void
+  skip_blank () noexcept
+  {
+    while (pos < input.size () && is_blank (input[pos]))
+      ++pos;
+  }
+
+  void
+  expect (const char ch, const std::string_view message)
+  {
+    if (peek () != ch)
+      fail (message, pos);
+    ++pos;
+  }
+
+  size_t
+  add_expression (const expression &added)
+  {
+    path.expressions.push_back (added);
+    return path.expressions.size () - 1;
+  }
+
+  // Parsing a filter may add queries, so the segments of query_index are
+  // only looked up again once a segment is complete.
+  void
+  parse_segments (const size_t query_index)
+  {
+    while (true)
+      {
+        const size_t segment_start{ pos };
+        skip_blank ();
+        segment parsed;
+        if (starts_with (".."))
+          {
+            pos += 2;
+            parsed.is_descendant = true;
+            if (peek () == '[')
+              parse_bracketed (parsed);
+            else
+              parsed.selectors.push_back (parse_dot_selector ());
+          }
+        else if (peek () == '.')
+          {
+            ++pos;
+            parsed.selectors.push_back (parse_dot_selector ());
+          }
+        else if (peek () == '[')
+          parse_bracketed (parsed);
+        else
+          {
+            pos = segment_start;
+            return;
+          }
+        const bool is_singular{
+          !parsed.is_descendant && parsed.selectors.size () == 1
+          && (parsed.selectors.front ().kind == selector_kind::name
+              || parsed.selectors.front ().kind == selector_kind::index)
+        };
+        query &current{ path.queries[query_index] };
+        current.is_singular = current.is_singular && is_singular;
+        current.segments.push_back (std::move (parsed));
+      }
+  }
+
+  selector
+  parse_dot_selector ()
+  {
+    selector parsed;
+    if (peek () == '*')
+      {
+        ++pos;
+        parsed.kind = selector_kind::wildcard;
+        return parsed;
+      }
+    if (!is_name_first (peek ()))
+      fail ("Expected a member name or '*' in a JSONPath segment", pos);
+    const size_t start{ pos };
+    while (pos < input.size ()
+           && (is_name_first (input[pos]) || is_digit (input[pos])))
+      ++pos;
+    parsed.kind = selector_kind::name;
+    parsed.name = input.substr (start, pos - start);
+    return parsed;
+  }
+
+  void
+  parse_bracketed (segment &parsed)
+  {
+    ++pos;
+    while (true)
+      {
+        skip_blank ();
+        parsed.selectors.push_back (parse_selector ());
+        skip_blank ();
+        if (peek () == ']')
+          {
+            ++pos;
+            return;
+          }
+        expect (',', "Expected ',' or ']' in a JSONPath selection");
+      }
+  }
+
+  selector
+  parse_selector ()
+  {
+    selector parsed;
+    switch (peek ())
+      {
+      case '\'':
+      case '"':
+        parsed.kind = selector_kind::name;
+        parsed.name = parse_string ();
+        return parsed;
+      case '*':
+        ++pos;
+        parsed.kind = selector_kind::wildcard;
+        return parsed;
+      case '?':
+        ++pos;
+        skip_blank ();
+        parsed.kind = selector_kind::filter;
+        parsed.filter = parse_logical_or ();
+        return parsed;
+      default:
+        break;
+      }
+
+    const size_t start{ pos };
+    parsed.start = parse_integer ();
+    skip_blank ();
+    if (peek () != ':')
+      {
+        if (!parsed.start.has_value ())
+          fail ("Expected a JSONPath selector", start);
+        parsed.kind = selector_kind::index;
+        parsed.index = *parsed.start;
+        return parsed;
+      }
+    ++pos;
+    skip_blank ();
+    parsed.kind = selector_kind::slice;
+    parsed.end = parse_integer ();
+    skip_blank ();
+    if (peek () == ':')
+      {
+        ++pos;
+        skip_blank ();
+        parsed.step = parse_integer ().value_or (1);
+      }
+    return parsed;
+  }
+
+  // nullopt when no integer starts at pos.
+  std::optional<std::int64_t>
+  parse_integer ()
+  {
+    const size_t start{ pos };
+    if (peek () == '-')
+      ++pos;
+    if (!is_digit (peek ()))
+      {
+        if (pos != start)
+          fail ("Expected a digit in a JSONPath index", pos);
+        return std::nullopt;
+      }
+    if (peek () == '0'
+        && (pos != start
+            || (pos + 1 < input.size () && is_digit (input[pos + 1]))))
+      fail ("Invalid JSONPath index", start);
+    while (is_digit (peek ()))
+      ++pos;
+    std::int64_t integer{};
+    const auto [ptr, ec] = std::from_chars (input.data () + start,
+                                            input.data () + pos, integer);
+    if (ec != std::errc{} || integer > max_index || integer < -max_index)
+      fail ("JSONPath index out of range", start);
+    return integer;
+  }
+
+  // Contents between the quotes, escapes included.
+  std::string
+  parse_string ()
+  {
+    const char quote{ input[pos] };
+    const size_t start{ ++pos };
+    while (pos < input.size () && input[pos] != quote)
+      pos += input[pos] == '\\' ? 2 : 1;
+    if (pos >= input.size ())
+      fail ("Unterminated JSONPath string literal", start - 1);
+    return std::string{ input.substr (start, pos++ - start) };
+  }
+
+  size_t
+  parse_logical_or ()
+  {
+    size_t lhs{ parse_logical_and () };
+    while (true)
+      {
+        skip_blank ();
+        if (!starts_with ("||"))
+          return lhs;
+        pos += 2;
+        skip_blank ();
+        lhs = add_expression (
+            { .kind = expression_kind::logical_or,
+              .lhs = lhs,
+              .rhs = parse_logical_and () });
+      }
+  }
+
+  size_t
+  parse_logical_and ()
+  {
+    size_t lhs{ parse_basic () };
+    while (true)
+      {
+        skip_blank ();
+        if (!starts_with ("&&"))
+          return lhs;
+        pos += 2;
+        skip_blank ();
+        lhs = add_expression (
+            { .kind = expression_kind::logical_and,
+              .lhs = lhs,
+              .rhs = parse_basic () });
+      }
+  }
+
+  size_t
+  parse_basic ()
+  {
+    if (peek () == '!')
+      {
+        ++pos;
+        skip_blank ();
+        const size_t operand{ peek () == '(' ? parse_parenthesized ()
+                                             : parse_test () };
+        return add_expression (
+            { .kind = expression_kind::logical_not, .lhs = operand });
+      }
+    if (peek () == '(')
+      return parse_parenthesized ();
+
+    const size_t lhs_start{ pos };
+    const size_t lhs{ parse_primary () };
+    const size_t op_start{ pos };
+    skip_blank ();
+    const std::optional<comparison_op> op{ parse_comparison_op () };
+    if (!op.has_value ())
+      {
+        pos = op_start;
+        return to_test (lhs, lhs_start);
+      }
+    skip_blank ();
+    const size_t rhs_start{ pos };
+    const size_t rhs{ parse_primary () };
+    return add_expression ({ .kind = expression_kind::comparison,
+                             .op = *op,
+                             .lhs = to_comparable (lhs, lhs_start),
+                             .rhs = to_comparable (rhs, rhs_start) });
+  }
+
+  size_t
+  parse_parenthesized ()
+  {
+    ++pos;
+    skip_blank ();
+    const size_t inner{ parse_logical_or () };
+    skip_blank ();
+    expect (')', "Expected ')' in a JSONPath filter");
+    return inner;
+  }
+
+  size_t
+  parse_test ()
+  {
+    const size_t start{ pos };
+    return to_test (parse_primary (), start);
+  }
+
+  std::optional<comparison_op>
+  parse_comparison_op ()
+  {
+    constexpr std::pair<std::string_view, comparison_op> ops[]{
+      { "==", comparison_op::equal },
+      { "!=", comparison_op::not_equal },
+      { "<=", comparison_op::less_equal },
+      { ">=", comparison_op::greater_equal },
+      { "<", comparison_op::less },
+      { ">", comparison_op::greater },
+    };
+    for (const auto &[token, op] : ops)
+      if (starts_with (token))
+        {
+          pos += token.size ();
+          return op;
+        }
+    return std::nullopt;
+  }
+
+  // A literal, a query (as an exists expression) or a function call.
+  size_t
+  parse_primary ()
+  {
+    const size_t start{ pos };
+    const char ch{ peek () };
+    if (ch == '@' || ch == '$')
+      {
+        ++pos;
+        path.queries.push_back ({ .is_relative = ch == '@' });
+        const size_t query_index{ path.queries.size () - 1 };
+        parse_segments (query_index);
+        return add_expression (
+            { .kind = expression_kind::exists, .target = query_index });
+      }
+    if (ch == '\'' || ch == '"')
+      return add_literal (Json{ parse_string () });
+    if (ch == '-' || is_digit (ch))
+      return add_literal (Json{ parse_number () });
+    if (!is_function_char (ch) || is_digit (ch) || ch == '_')
+      fail ("Expected a JSONPath filter expression", start);
+
+    while (is_function_char (peek ()))
+      ++pos;
+    const std::string_view name{ input.substr (start, pos - start) };
+    if (peek () == '(')
+      return parse_function (name, start);
+    if (name == "true" || name == "false")
+      return add_literal (Json{ name == "true" });
+    if (name == "null")
+      return add_literal (Json{ nullptr });
+    fail ("Unknown JSONPath literal", start);
+  }
+
+  double
+  parse_number ()
+  {
+    const size_t start{ pos };
+    while (pos < input.size ()
+           && (is_digit (input[pos]) || input[pos] == '.' || input[pos] == 'e'
+               || input[pos] == 'E' || input[pos] == '+'
+               || input[pos] == '-'))
+      ++pos;
+    double number{};
+    const auto [ptr, ec] = std::from_chars (input.data () + start,
+                                            input.data () + pos, number);
+    if (ec != std::errc{} || ptr != input.data () + pos)
+      fail ("Invalid JSONPath number literal", start);
+    return number;
+  }
+
+  size_t
+  add_literal (Json literal)
+  {
+    path.literals.push_back (std::move (literal));
+    return add_expression ({ .kind = expression_kind::literal,
+                             .target = path.literals.size () - 1 });
+  }
+
+  size_t
+  parse_function (const std::string_view name, const size_t start)
+  {
+    expression call;
+    size_t arity{ 1 };
+    bool takes_nodes{};
+    if (name == "length")
+      call.kind = expression_kind::length;
+    else if (name == "count")
+      {
+        call.kind = expression_kind::count;
+        takes_nodes = true;
+      }
+    else if (name == "value")
+      {
+        call.kind = expression_kind::value;
+        takes_nodes = true;
+      }
+    else if (name == "match" || name == "search")
+      {
+        call.kind = name == "match" ? expression_kind::match
+                                    : expression_kind::search;
+        arity = 2;
+      }
+    else
+      fail ("Unknown JSONPath function", start);
+
+    ++pos;
+    for (size_t i{}; i < arity; ++i)
+      {
+        skip_blank ();
+        if (i != 0)
+          {
+            expect (',', "Expected ',' between JSONPath function arguments");
+            skip_blank ();
+          }
+        const size_t argument_start{ pos };
+        size_t argument{ parse_primary () };
+        if (takes_nodes)
+          {
+            if (path.expressions[argument].kind != expression_kind::exists)
+              fail ("JSONPath function expects a query argument",
+                    argument_start);
+          }
+        else
+          argument = to_comparable (argument, argument_start);
+        (i == 0 ? call.lhs : call.rhs) = argument;
+      }
+    skip_blank ();
+    expect (')', "Expected ')' after the JSONPath function arguments");
+
+    // patterns given as literals are compiled once, here
+    if (call.kind == expression_kind::match
+        || call.kind == expression_kind::search)
+      {
+        const expression &pattern{ path.expressions[call.rhs] };
+        if (pattern.kind == expression_kind::literal)
+          if (const auto source
+              = path.literals[pattern.target].get_json_value_as_string ())
+            {
+              path.patterns.push_back (compile_pattern (source->get ()));
+              call.target = path.patterns.size () - 1;
+            }
+      }
+    return add_expression (call);
+  }
+
+  // Comparison operands and value arguments: literals, singular queries
+  // and functions returning a value.
+  size_t
+  to_comparable (const size_t index, const size_t start)
+  {
+    expression &operand{ path.expressions[index] };
+    switch (operand.kind)
+      {
+      case expression_kind::exists:
+        if (!path.queries[operand.target].is_singular)
+          fail ("Non-singular JSONPath query used as a value", start);
+        operand.kind = expression_kind::singular_query;
+        return index;
+      case expression_kind::literal:
+      case expression_kind::length:
+      case expression_kind::count:
+      case expression_kind::value:
+        return index;
+      default:
+        fail ("JSONPath expression is not a value", start);
+      }
+  }
+
+  size_t
+  to_test (const size_t index, const size_t start)
+  {
+    switch (path.expressions[index].kind)
+      {
+      case expression_kind::exists:
+      case expression_kind::match:
+      case expression_kind::search:
+        return index;
+      default:
+        fail ("JSONPath expression is not a test", start);
+      }
+  }
+
+  json_path &path;
+  const std::string_view input;
+  size_t pos{};
+};
+
+json_path::json_path (const std::string_view query)
+{
+  compiler{ *this, query }.compile ();
+}
+
+std::vector<const Json *>
+json_path::select (const Json &json) const
+{
+  std::vector<const Json *> nodes;
+  evaluate (queries[main_query], json, json, nodes);
+  return nodes;
+}
+
+std::vector<Json *>
+json_path::select (Json &json) const
+{
+  std::vector<Json *> nodes;
+  evaluate (queries[main_query], json, std::as_const (json), nodes);
+  return nodes;
+}
+
+template <typename JsonType>
+void
+json_path::evaluate (const query &path, JsonType &start, const Json &root,
+                     std::vector<JsonType *> &nodes) const
+{
+  nodes.assign (1, &start);
+  std::vector<JsonType *> next;
+  std::vector<JsonType *> pending;
+  for (const segment &current : path.segments)
+    {
+      next.clear ();
+      for (JsonType *node : nodes)
+        {
+          if (!current.is_descendant)
+            {
+              for (const selector &child : current.selectors)
+                select_children (child, *node, root, next);
+              continue;
+            }
+          // the node and its descendants, parents before their children
+          pending.assign (1, node);
+          while (!pending.empty ())
+            {
+              JsonType *visited{ pending.back () };
+              pending.pop_back ();
+              for (const selector &child : current.selectors)
+                select_children (child, *visited, root, next);
+              const size_t first_child{ pending.size () };
+              for (JsonType &child : visited->values ())
+                pending.push_back (&child);
+              std::reverse (pending.begin ()
+                                + static_cast<std::ptrdiff_t> (first_child),
+                            pending.end ());
+            }
+        }
+      nodes.swap (next);
+    }
+}
+
+template <typename JsonType>
+void
+json_path::select_children (const selector &child, JsonType &json,
+                            const Json &root,
+                            std::vector<JsonType *> &nodes) const
+{
+  switch (child.kind)
+    {
+    case selector_kind::name:
+      if (auto json_object = json.get_json_value_as_object ())
+        {
+          auto &members = json_object->get ();
+          const auto found = members.find (child.name);
+          if (found != members.end ())
+            nodes.push_back (&found->second);
+        }
+      return;
+    case selector_kind::wildcard:
+      for (JsonType &element : json.values ())
+        nodes.push_back (&element);
+      return;
+    case selector_kind::index:
+      if (auto json_array = json.get_json_value_as_array ())
+        {
+          auto &elements = json_array->get ();
+          const auto size{ static_cast<std::int64_t> (elements.size ()) };
+          const std::int64_t index{ child.index < 0 ? child.index + size
+                                                    : child.index };
+          if (index >= 0 && index < size)
+            nodes.push_back (&elements[static_cast<size_t> (index)]);
+        }
+      return;
+    case selector_kind::slice:
+      if (auto json_array = json.get_json_value_as_array ())
+        {
+          auto &elements = json_array->get ();
+          const auto size{ static_cast<std::int64_t> (elements.size ()) };
+          const auto normalize = [size] (const std::int64_t index) {
+            return index < 0 ? index + size : index;
+          };
+          if (child.step > 0)
+            {
+              const std::int64_t lower{ std::clamp (
+                  normalize (child.start.value_or (0)), std::int64_t{},
+                  size) };
+              const std::int64_t upper{ std::clamp (
+                  normalize (child.end.value_or (size)), std::int64_t{},
+                  size) };
+              for (std::int64_t i{ lower }; i < upper; i += child.step)
+                nodes.push_back (&elements[static_cast<size_t> (i)]);
+            }
+          else if (child.step < 0)
+            {
+              const std::int64_t upper{ std::clamp (
+                  normalize (child.start.value_or (size - 1)),
+                  std::int64_t{ -1 }, size - 1) };
+              const std::int64_t lower{ std::clamp (
+                  normalize (child.end.value_or (-size - 1)),
+                  std::int64_t{ -1 }, size - 1) };
+              for (std::int64_t i{ upper }; lower < i; i += child.step)
+                nodes.push_back (&elements[static_cast<size_t> (i)]);
+            }
+        }
+      return;
+    case selector_kind::filter:
+      for (JsonType &element : json.values ())
+        if (test (child.filter, element, root))
+          nodes.push_back (&element);
+      return;
+    }
+}
+
+const Json *
+json_path::select_singular (const query &path, const Json &current,
+                            const Json &root) const
+{
+  const Json *node{ path.is_relative ? &current : &root };
+  for (const segment &child : path.segments)
+    {
+      const selector &step{ child.selectors.front () };
+      if (step.kind == selector_kind::name)
+        {
+          const auto json_object = node->get_json_value_as_object ();
+          if (!json_object.has_value ())
+            return nullptr;
+          const auto found = json_object->get ().find (step.name);
+          if (found == json_object->get ().end ())
+            return nullptr;
+          node = &found->second;
+          continue;
+        }
+      const auto json_array = node->get_json_value_as_array ();
+      if (!json_array.has_value ())
+        return nullptr;
+      const auto size{ static_cast<std::int64_t> (json_array->get ().size ()) };
+      const std::int64_t index{ step.index < 0 ? step.index + size
+                                               : step.index };
+      if (index < 0 || index >= size)
+        return nullptr;
+      node = &json_array->get ()[static_cast<size_t> (index)];
+    }
+  return node;
+}
+
+bool
+json_path::test (const std::size_t index, const Json &current,
+                 const Json &root) const
+{
+  const expression &tested{ expressions[index] };
+  switch (tested.kind)
+    {
+    case expression_kind::logical_or:
+      return test (tested.lhs, current, root)
+             || test (tested.rhs, current, root);
+    case expression_kind::logical_and:
+      return test (tested.lhs, current, root)
+             && test (tested.rhs, current, root);
+    case expression_kind::logical_not:
+      return !test (tested.lhs, current, root);
+    case expression_kind::exists:
+      {
+        const query &path{ queries[tested.target] };
+        if (path.is_singular)
+          return select_singular (path, current, root) != nullptr;
+        std::vector<const Json *> nodes;
+        evaluate (path, path.is_relative ? current : root, root, nodes);
+        return !nodes.empty ();
+      }
+    case expression_kind::match:
+    case expression_kind::search:
+      return matches (tested, current, root);
+    case expression_kind::comparison:
+      break;
+    default:
+      return false;
+    }
+
+  const comparable lhs{ evaluate_comparable (tested.lhs, current, root) };
+  const comparable rhs{ evaluate_comparable (tested.rhs, current, root) };
+  const auto number_of = [] (const comparable &operand) {
+    if (operand.node != nullptr && operand.node->is_json_number ())
+      return std::optional<double>{ operand.node->to_number () };
+    return operand.number;
+  };
+  const auto equal = [&] () {
+    const std::optional<double> left{ number_of (lhs) };
+    const std::optional<double> right{ number_of (rhs) };
+    if (left.has_value () || right.has_value ())
+      return left == right;
+    if (lhs.node == nullptr || rhs.node == nullptr)
+      return lhs.node == rhs.node;
+    return *lhs.node == *rhs.node;
+  };
+  // numbers compare numerically and strings bytewise, which orders UTF-8
+  // by code point; anything else is neither less nor greater
+  const auto less = [&] (const comparable &left, const comparable &right) {
+    const std::optional<double> left_number{ number_of (left) };
+    const std::optional<double> right_number{ number_of (right) };
+    if (left_number.has_value () && right_number.has_value ())
+      return *left_number < *right_number;
+    if (left.node == nullptr || right.node == nullptr
+        || !left.node->is_json_string () || !right.node->is_json_string ())
+      return false;
+    return left.node->get_json_value_as_string ()->get ()
+           < right.node->get_json_value_as_string ()->get ();
+  };
+  switch (tested.op)
+    {
+    case comparison_op::equal:
+      return equal ();
+    case comparison_op::not_equal:
+      return !equal ();
+    case comparison_op::less:
+      return less (lhs, rhs);
+    case comparison_op::less_equal:
+      return less (lhs, rhs) || equal ();
+    case comparison_op::greater:
+      return less (rhs, lhs);
+    case comparison_op::greater_equal:
+      return less (rhs, lhs) || equal ();
+    }
+  return false;
+}
+
+json_path::comparable
+json_path::evaluate_comparable (const std::size_t index, const Json &current,
+                                const Json &root) const
+{
+  const expression &evaluated{ expressions[index] };
+  switch (evaluated.kind)
+    {
+    case expression_kind::literal:
+      return { &literals[evaluated.target], std::nullopt };
+    case expression_kind::singular_query:
+      return { select_singular (queries[evaluated.target], current, root),
+               std::nullopt };
+    case expression_kind::length:
+      {
+        const comparable argument{ evaluate_comparable (evaluated.lhs,
+                                                        current, root) };
+        if (argument.node == nullptr)
+          return {};
+        if (const auto str = argument.node->get_json_value_as_string ())
+          return { nullptr, static_cast<double> (
+                                code_point_count (str->get ())) };
+        if (const std::optional<size_t> size{ container_size (
+                *argument.node) })
+          return { nullptr, static_cast<double> (*size) };
+        return {};
+      }
+    case expression_kind::count:
+    case expression_kind::value:
+      {
+        const query &path{ queries[expressions[evaluated.lhs].target] };
+        std::vector<const Json *> nodes;
+        evaluate (path, path.is_relative ? current : root, root, nodes);
+        if (evaluated.kind == expression_kind::count)
+          return { nullptr, static_cast<double> (nodes.size ()) };
+        if (nodes.size () == 1)
+          return { nodes.front (), std::nullopt };
+        return {};
+      }
+    default:
+      return {};
+    }
+}
+
+bool
+json_path::matches (const expression &function, const Json &current,
+                    const Json &root) const
+{
+  const comparable str{ evaluate_comparable (function.lhs, current, root) };
+  if (str.node == nullptr || !str.node->is_json_string ())
+    return false;
+  const std::string &subject{ str.node->get_json_value_as_string ()->get () };
+
+  std::optional<std::regex> compiled;
+  const std::optional<std::regex> *pattern{ &compiled };
+  if (function.target != no_index)
+    pattern = &patterns[function.target];
+  else
+    {
+      const comparable source{ evaluate_comparable (function.rhs, current,
+                                                    root) };
+      if (source.node == nullptr || !source.node->is_json_string ())
+        return false;
+      compiled = compile_pattern (
+          source.node->get_json_value_as_string ()->get ());
+    }
+  if (!pattern->has_value ())
+    return false;
+  return function.kind == expression_kind::match
+             ? std::regex_match (subject, **pattern)
+             : std::regex_search (subject, **pattern);
+}
+
+} // namespace simple_json
@@ -0,0 +1,667 @@
+#include "../include/simple_json_schema.h"
+#include "../include/simple_json_binding.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <unordered_set>
+
+namespace simple_json
+{
+
+namespace
+{
+
+constexpr std::array<std::string_view, 7> type_names{
+  "null", "boolean", "number", "string", "array", "object", "integer"
+};
+
+constexpr std::array<std::string_view, 21> unsupported_keywords{
+  "$ref",          "$dynamicRef",       "$recursiveRef",
+  "allOf",         "anyOf",             "oneOf",
+  "not",           "if",                "dependencies",
+  "prefixItems",   "additionalItems",   "unevaluatedItems",
+  "uniqueItems",   "contains",          "minContains",
+  "maxContains",   "propertyNames",     "patternProperties",
+  "dependentRequired", "dependentSchemas", "unevaluatedProperties"
+};
+
+std::string
+type_list (const unsigned type_mask)
+{
+  std::string names;
+  for (size_t i{}; i < type_names.size (); ++i)
+    if ((type_mask & (1u << i)) != 0)
+      {
+        if (!names.empty ())
+          names += ", ";
+        names += type_names[i];
+      }
+  return names.empty () ? std::string{ "nothing" } : names;
+}
+
+size_t
+code_point_count (const std::string_view str) noexcept
+{
+  return static_cast<size_t> (std::count_if (
+      str.begin (), str.end (), [] (const char ch) {
+        return (static_cast<unsigned char> (ch) & 0xC0) != 0x80;
+      }));
+}
+
+double
+number_keyword (const Json &value, const std::string &keyword)
+{
+  if (!value.is_json_number ())
+    throw std::invalid_argument{ std::format (
+        "JSON schema keyword {} must be a number!", keyword) };
+  return value.to_number ();
+}
+
+size_t
+size_keyword (const Json &value, const std::string &keyword)
+{
+  const double number{ number_keyword (value, keyword) };
+  if (number < 0 || number != std::floor (number))
+    throw std::invalid_argument{ std::format (
+        "JSON schema keyword {} must be a non-negative integer!", keyword) };
+  return static_cast<size_t> (number);
+}
+
+void
+prepend_path (schema_violation &violation, const std::string_view token)
+{
+  violation.path.insert (0, append_json_pointer ("", token));
+}
+
+} // namespace
+
+class json_schema::required_tracker
+{
+public:
+  explicit required_tracker (const size_t count) : count{ count }
+  {
+    if (count > 64)
+      overflow.resize (count);
+  }
+
+  void
+  mark (const int bit)
+  {
+    if (bit < 0)
+      return;
+    if (count <= 64)
+      mask |= std::uint64_t{ 1 } << bit;
+    else
+      overflow[static_cast<size_t> (bit)] = true;
+  }
+
+  std::optional<size_t>
+  first_missing () const
+  {
+    for (size_t i{}; i < count; ++i)
+      if (count <= 64 ? (mask & (std::uint64_t{ 1 } << i)) == 0 : !overflow[i])
+        return i;
+    return std::nullopt;
+  }
+
+private:
+  size_t count;
+  std::uint64_t mask{};
+  std::vector<bool> overflow;
+};
+
+json_schema::json_schema (const Json &schema)
+{
+  nodes.emplace_back ();
+  nodes.emplace_back ().type_mask = 0;
+  root = compile (schema);
+}
+
+size_t
+json_schema::compile (const Json &schema)
+{
+  if (const auto is_accepting = schema.get_json_value_as_bool ())
+    return *is_accepting ? accept_all_node : reject_all_node;
+  const auto keywords = schema.get_json_value_as_object ();
+  if (!keywords.has_value ())
+    throw std::invalid_argument (
+        "JSON schema must be a JSON object or a boolean!");
+
+  // nodes may be reallocated by the recursive compile () calls, so the
+  // node being built is always accessed through its index
+  const size_t index{ nodes.size () };
+  nodes.emplace_back ();
+  std::vector<std::string> required_keys;
+
+  const auto set_lower_bound = [&] (const double bound, const bool exclusive) {
+    node &current{ nodes[index] };
+    if (bound > current.minimum
+        || (bound == current.minimum && exclusive))
+      {
+        current.minimum = bound;
+        current.is_minimum_exclusive = exclusive;
+      }
+  };
+  const auto set_upper_bound = [&] (const double bound, const bool exclusive) {
+    node &current{ nodes[index] };
+    if (bound < current.maximum
+        || (bound == current.maximum && exclusive))
+      {
+        current.maximum = bound;
+        current.is_maximum_exclusive = exclusive;
+      }
+  };
+
+  for (const auto &[keyword, value] : keywords->get ())
+    {
+      if (keyword == "type")
+        {
+          std::vector<Json> names;
+          if (value.is_json_string ())
+            names.push_back (value);
+          else if (const auto json_array = value.get_json_value_as_array ())
+            names = json_array->get ();
+          unsigned type_mask{};
+          for (const Json &name : names)
+            {
+              const auto str = name.get_json_value_as_string ();
+              const auto found
+                  = str.has_value () ? std::find (type_names.begin (),
+                                                  type_names.end (), str->get ())
+                                     : type_names.end ();
+              if (found == type_names.end ())
+                throw std::invalid_argument (
+                    "Invalid type in JSON schema keyword type!");
+              type_mask |= 1u << (found - type_names.begin ());
+            }
+          if (type_mask == 0)
+            throw std::invalid_argument (
+                "JSON schema keyword type must name at least one type!");
+          nodes[index].type_mask = type_mask;
+        }
+      else if (keyword == "enum" || keyword == "const")
+        {
+          nodes[index].has_enum = true;
+          nodes[index].enum_begin = enum_values.size ();
+          if (keyword == "const")
+            enum_values.push_back (value);
+          else if (const auto json_array = value.get_json_value_as_array ())
+            enum_values.insert (enum_values.end (), json_array->get ().begin (),
+                                json_array->get ().end ());
+          else
+            throw std::invalid_argument (
+                "JSON schema keyword enum must be an array!");
+          nodes[index].enum_end = enum_values.size ();
+        }
+      else if (keyword == "minimum")
+        set_lower_bound (number_keyword (value, keyword), false);
+      else if (keyword == "exclusiveMinimum")
+        set_lower_bound (number_keyword (value, keyword), true);
+      else if (keyword == "maximum")
+        set_upper_bound (number_keyword (value, keyword), false);
+      else if (keyword == "exclusiveMaximum")
+        set_upper_bound (number_keyword (value, keyword), true);
+      else if (keyword == "multipleOf")
+        {
+          const double divisor{ number_keyword (value, keyword) };
+          if (!(divisor > 0) || !std::isfinite (divisor))
+            throw std::invalid_argument (
+                "JSON schema keyword multipleOf must be greater than 0!");
+          nodes[index].multiple_of = divisor;
+        }
+      else if (keyword == "minLength")
+        nodes[index].min_length = size_keyword (value, keyword);
+      else if (keyword == "maxLength")
+        nodes[index].max_length = size_keyword (value, keyword);
+      else if (keyword == "minItems")
+        nodes[index].min_items = size_keyword (value, keyword);
+      else if (keyword == "maxItems")
+        nodes[index].max_items = size_keyword (value, keyword);
+      else if (keyword == "minProperties")
+        nodes[index].min_properties = size_keyword (value, keyword);
+      else if (keyword == "maxProperties")
+        nodes[index].max_properties = size_keyword (value, keyword);
+      else if (keyword == "pattern")
+        {
+          const auto source = value.get_json_value_as_string ();
+          if (!source.has_value ())
+            throw std::invalid_argument (
+                "JSON schema keyword pattern must be a string!");
+          try
+            {
+              patterns.emplace_back (source->get (),
+                                     std::regex::ECMAScript
+                                         | std::regex::optimize);
+            }
+          catch (const std::regex_error &)
+            {
+              throw std::invalid_argument{ std::format (
+                  "Invalid JSON schema pattern {}!", source->get ()) };
+            }
+          pattern_sources.push_back (source->get ());
+          nodes[index].pattern = patterns.size () - 1;
+        }
+      else if (keyword == "properties")
+        {
+          const auto properties = value.get_json_value_as_object ();
+          if (!properties.has_value ())
+            throw std::invalid_argument (
+                "JSON schema keyword properties must be an object!");
+          for (const auto &[name, property_schema] : properties->get ())
+            {
+              const size_t child{ compile (property_schema) };
+              nodes[index].properties[name].node = child;
+            }
+        }
+      else if (keyword == "required")
+        {
+          const auto keys = value.get_json_value_as_array ();
+          if (!keys.has_value ())
+            throw std::invalid_argument (
+                "JSON schema keyword required must be an array!");
+          for (const Json &key : keys->get ())
+            {
+              const auto str = key.get_json_value_as_string ();
+              if (!str.has_value ())
+                throw std::invalid_argument (
+                    "JSON schema keyword required must list strings!");
+              required_keys.push_back (str->get ());
+            }
+        }
+      else if (keyword == "additionalProperties")
+        {
+          const size_t child{ compile (value) };
+          nodes[index].additional_node = child;
+        }
+      else if (keyword == "items")
+        {
+          const size_t child{ compile (value) };
+          nodes[index].items_node = child;
+        }
+      else if (std::find (unsupported_keywords.begin (),
+                          unsupported_keywords.end (), keyword)
+               != unsupported_keywords.end ())
+        throw std::invalid_argument{ std::format (
+            "Unsupported JSON schema keyword {}!", keyword) };
+    }
+
+  node &current{ nodes[index] };
+  for (std::string &key : required_keys)
+    {
+      property &required_property{ current.properties[key] };
+      if (required_property.required_bit >= 0)
+        continue;
+      required_property.required_bit
+          = static_cast<int> (current.required.size ());
+      current.required.push_back (std::move (key));
+    }
+  return index;
+}
+
+bool
+json_schema::check_type (const node &schema_node, const json_type type,
+                         const double number,
+                         schema_violation &violation) const
+{
+  if ((schema_node.type_mask & (1u << static_cast<unsigned> (type))) != 0
+      || (type == json_type::number_t
+          && (schema_node.type_mask & integer_bit) != 0
+          && std::isfinite (number) && number == std::floor (number)))
+    return true;
+  violation.message = schema_node.type_mask == 0
+                          ? std::string{ "value is not allowed" }
+                          : std::format ("expected {}",
+                                         type_list (schema_node.type_mask));
+  return false;
+}
+
+bool
+json_schema::check_number (const node &schema_node, const double number,
+                           schema_violation &violation) const
+{
+  if (number < schema_node.minimum
+      || (schema_node.is_minimum_exclusive && number == schema_node.minimum))
+    {
+      violation.message = std::format (
+          "{} is less than {}minimum {}", number,
+          schema_node.is_minimum_exclusive ? "exclusive " : "",
+          schema_node.minimum);
+      return false;
+    }
+  if (number > schema_node.maximum
+      || (schema_node.is_maximum_exclusive && number == schema_node.maximum))
+    {
+      violation.message = std::format (
+          "{} is greater than {}maximum {}", number,
+          schema_node.is_maximum_exclusive ? "exclusive " : "",
+          schema_node.maximum);
+      return false;
+    }
+  if (schema_node.multiple_of != 0)
+    {
+      // relative tolerance, so that 0.3 is a multiple of 0.1
+      const double quotient{ number / schema_node.multiple_of };
+      if (!std::isfinite (quotient)
+          || std::abs (quotient - std::round (quotient))
+                 > 1e-9 * std::max (1.0, std::abs (quotient)))
+        {
+          violation.message = std::format ("{} is not a multiple of {}",
+                                           number, schema_node.multiple_of);
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+json_schema::check_property_count (const node &schema_node,
+                                   const size_t count,
+                                   schema_violation &violation) const
+{
+  if (count < schema_node.min_properties
+      || count > schema_node.max_properties)
+    {
+      violation.message = std::format (
+          "object has {} properties, expected {} to {}", count,
+          schema_node.min_properties, schema_node.max_properties);
+      return false;
+    }
+  return true;
+}
+
+bool
+json_schema::check_string (const node &schema_node, const std::string_view str,
+                           schema_violation &violation) const
+{
+  if (schema_node.min_length != 0
+      || schema_node.max_length != std::numeric_limits<size_t>::max ())
+    {
+      const size_t length{ code_point_count (str) };
+      if (length < schema_node.min_length)
+        {
+          violation.message = std::format ("string is shorter than {}",
+                                           schema_node.min_length);
+          return false;
+        }
+      if (length > schema_node.max_length)
+        {
+          violation.message = std::format ("string is longer than {}",
+                                           schema_node.max_length);
+          return false;
+        }
+    }
+  if (schema_node.pattern != no_index
+      && !std::regex_search (str.begin (), str.end (),
+                             patterns[schema_node.pattern]))
+    {
+      violation.message = std::format ("string does not match pattern {}",
+                                       pattern_sources[schema_node.pattern]);
+      return false;
+    }
+  return true;
+}
+
+bool
+json_schema::validate_tree (const size_t index, const Json &json,
+                            schema_violation &violation) const
+{
+  if (index == accept_all_node)
+    return true;
+  const node &schema_node{ nodes[index] };
+  const json_type type{ json.get_json_element_type () };
+  if (!check_type (schema_node, type, json.to_number (), violation))
+    return false;
+  if (schema_node.has_enum
+      && std::find (enum_values.begin () + schema_node.enum_begin,
+                    enum_values.begin () + schema_node.enum_end, json)
+             == enum_values.begin () + schema_node.enum_end)
+    {
+      violation.message = "value is not one of the enumerated values";
+      return false;
+    }
+
+  switch (type)
+    {
+    case json_type::number_t:
+      return check_number (schema_node, json.to_number (), violation);
+    case json_type::string_t:
+      return check_string (schema_node,
+                           json.get_json_value_as_string ()->get (), violation);
+    case json_type::array_t:
+      {
+        const std::vector<Json> &elements{
+          json.get_json_value_as_array ()->get ()
+        };
+        if (elements.size () < schema_node.min_items
+            || elements.size () > schema_node.max_items)
+          {
+            violation.message = std::format (
+                "array has {} items, expected {} to {}", elements.size (),
+                schema_node.min_items, schema_node.max_items);
+            return false;
+          }
+        for (size_t i{}; i < elements.size (); ++i)
+          if (!validate_tree (schema_node.items_node, elements[i], violation))
+            {
+              prepend_path (violation, std::to_string (i));
+              return false;
+            }
+        return true;
+      }
+    case json_type::object_t:
+      {
+        const auto &members = json.get_json_value_as_object ()->get ();
+        if (!check_property_count (schema_node, members.size (), violation))
+          return false;
+        required_tracker tracker{ schema_node.required.size () };
+        for (const auto &[key, element] : members)
+          {
+            size_t child{ schema_node.additional_node };
+            if (const auto found = schema_node.properties.find (key);
+                found != schema_node.properties.end ())
+              {
+                tracker.mark (found->second.required_bit);
+                if (found->second.node != no_index)
+                  child = found->second.node;
+              }
+            if (!validate_tree (child, element, violation))
+              {
+                prepend_path (violation, key);
+                return false;
+              }
+          }
+        if (const auto missing = tracker.first_missing ())
+          {
+            violation.message = std::format ("missing required property {}",
+                                             schema_node.required[*missing]);
+            return false;
+          }
+        return true;
+      }
+    default:
+      return true;
+    }
+}
+
+bool
+json_schema::validate_text (const size_t index, json_reader &reader,
+                            schema_violation &violation) const
+{
+  if (index == accept_all_node)
+    {
+      reader.skip_value ();
+      return true;
+    }
+  const node &schema_node{ nodes[index] };
+  if (schema_node.has_enum)
+    {
+      Json value;
+      read_json_value (reader, value);
+      return validate_tree (index, value, violation);
+    }
+
+  switch (reader.peek ())
+    {
+    case '{':
+      {
+        if (!check_type (schema_node, json_type::object_t, 0, violation))
+          return false;
+        reader.expect ('{');
+        required_tracker tracker{ schema_node.required.size () };
+        // distinct keys, as parse () keeps one member per key
+        std::unordered_set<std::string_view> keys;
+        std::vector<std::pair<std::string_view, schema_violation> > pending;
+        const bool is_counting{
+          schema_node.min_properties != 0
+          || schema_node.max_properties != std::numeric_limits<size_t>::max ()
+        };
+        if (!reader.consume ('}'))
+          {
+            do
+              {
+                // keys and strings are measured raw, as parse () stores
+                // them, so text and tree validation agree
+                const std::string_view key{ reader.read_raw_string () };
+                if (is_counting)
+                  keys.insert (key);
+                reader.expect (':');
+                size_t child{ schema_node.additional_node };
+                if (const auto found = schema_node.properties.find (key);
+                    found != schema_node.properties.end ())
+                  {
+                    tracker.mark (found->second.required_bit);
+                    if (found->second.node != no_index)
+                      child = found->second.node;
+                  }
+                // parse () keeps the last member of a repeated key, so a
+                // violation only counts once no later member replaces it
+                const json_reader value_start{ reader };
+                schema_violation member_violation;
+                if (validate_text (child, reader, member_violation))
+                  std::erase_if (pending, [&] (const auto &entry) {
+                    return entry.first == key;
+                  });
+                else
+                  {
+                    prepend_path (member_violation, key);
+                    pending.emplace_back (key, std::move (member_violation));
+                    reader = value_start;
+                    reader.skip_value ();
+                  }
+              }
+            while (reader.consume (','));
+            reader.expect ('}');
+          }
+        if (!pending.empty ())
+          {
+            violation = std::move (pending.front ().second);
+            return false;
+          }
+        if (!check_property_count (schema_node, keys.size (), violation))
+          return false;
+        if (const auto missing = tracker.first_missing ())
+          {
+            violation.message = std::format ("missing required property {}",
+                                             schema_node.required[*missing]);
+            return false;
+          }
+        return true;
+      }
+    case '[':
+      {
+        if (!check_type (schema_node, json_type::array_t, 0, violation))
+          return false;
+        reader.expect ('[');
+        size_t count{};
+        if (!reader.consume (']'))
+          {
+            do
+              {
+                if (!validate_text (schema_node.items_node, reader, violation))
+                  {
+                    prepend_path (violation, std::to_string (count));
+                    return false;
+                  }
+                ++count;
+              }
+            while (reader.consume (','));
+            reader.expect (']');
+          }
+        if (count < schema_node.min_items || count > schema_node.max_items)
+          {
+            violation.message = std::format (
+                "array has {} items, expected {} to {}", count,
+                schema_node.min_items, schema_node.max_items);
+            return false;
+          }
+        return true;
+      }
+    case '"':
+      {
+        if (!check_type (schema_node, json_type::string_t, 0, violation))
+          return false;
+        return check_string (schema_node, reader.read_raw_string (),
+                             violation);
+      }
+    case 't':
+    case 'f':
+      reader.read_boolean ();
+      return check_type (schema_node, json_type::boolean_t, 0, violation);
+    case 'n':
+      if (!reader.consume_null ())
+        reader.fail ("Invalid json value!");
+      return check_type (schema_node, json_type::null_t, 0, violation);
+    default:
+      {
+        const std::string_view text{ reader.read_number_text () };
+        double number{};
+        const auto [ptr, ec] = std::from_chars (
+            text.data (), text.data () + text.size (), number);
+        if (ec != std::errc{} || ptr != text.data () + text.size ())
+          reader.fail ("Invalid json number!");
+        return check_type (schema_node, json_type::number_t, number, violation)
+               && check_number (schema_node, number, violation);
+      }
+    }
+}
+
+std::optional<schema_violation>
+json_schema::validate (const Json &json) const
+{
+  schema_violation violation;
+  if (!validate_tree (root, json, violation))
+    return violation;
+  return std::nullopt;
+}
+
+std::optional<schema_violation>
+json_schema::validate (const std::string_view input) const
+{
+  schema_violation violation;
+  try
+    {
+      json_reader reader{ input };
+      if (!validate_text (root, reader, violation))
+        return violation;
+      reader.expect_end ();
+    }
+  catch (const std::invalid_argument &error)
+    {
+      return schema_violation{ {}, error.what () };
+    }
+  return std::nullopt;
+}
+
+result_type
+json_schema::parse (const std::string_view input) const
+{
+  if (const auto violation = validate (input))
+    return result_type{ std::nullopt, status::fail,
+                        std::format ("JSON schema violation at '{}': {}",
+                                     violation->path, violation->message) };
+  return simple_json::parse (input);
+}
+
+} // namespace simple_json
@@ -0,0 +1,378 @@
+#include "../include/simple_json_tape.h"
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace simple_json
+{
+
+namespace
+{
+
+constexpr std::uint64_t payload_mask{ (std::uint64_t{ 1 } << 56) - 1 };
+
+constexpr std::uint64_t
+make_word (const char tag, const std::uint64_t payload = 0) noexcept
+{
+  return (std::uint64_t{ static_cast<unsigned char> (tag) } << 56) | payload;
+}
+
+[[noreturn]] void
+fail (const std::string_view message, const size_t pos)
+{
+  throw std::invalid_argument{ std::format ("{} at offset {}!", message,
+                                            pos) };
+}
+
+bool
+is_number_char (const char ch) noexcept
+{
+  return (ch >= '0' && ch <= '9') || ch == '.' || ch == 'e' || ch == 'E'
+         || ch == '+' || ch == '-';
+}
+
+class tape_builder
+{
+public:
+  tape_builder (const std::string_view input, std::vector<std::uint64_t> &words,
+                std::vector<char> &strings)
+      : input{ input }, words{ words }, strings{ strings }
+  {
+    // typical documents need fewer words than a quarter of their bytes;
+    // strings never take more than the input
+    words.reserve (input.size () / 4 + 2);
+    strings.reserve (input.size ());
+  }
+
+  void
+  build ()
+  {
+    parse_value ();
+    while (!open_containers.empty ())
+      {
+        open_container &container{ open_containers.back () };
+        const char close{ container.is_object ? '}' : ']' };
+        skip_whitespace (input, pos);
+        if (pos >= input.size ())
+          fail ("Unexpected end of json data", pos);
+        if (input[pos] == close)
+          {
+            ++pos;
+            close_container ();
+          }
+        else if (!container.expects_separator)
+          parse_element (container);
+        else if (input[pos] == ',')
+          {
+            ++pos;
+            parse_element (container);
+          }
+        else
+          fail (container.is_object ? "Expected ',' or '}' in JSON object"
+                                    : "Expected ',' or ']' in JSON array",
+                pos);
+      }
+    skip_whitespace (input, pos);
+    if (pos != input.size ())
+      fail ("Unexpected data after the JSON value", pos);
+  }
+
+private:
+  struct open_container
+  {
+    size_t word_index;
+    std::uint64_t count;
+    bool is_object;
+    bool expects_separator;
+  };
+
+  void
+  parse_element (open_container &container)
+  {
+    ++container.count;
+    container.expects_separator = true;
+    const bool is_object{ container.is_object };
+    // parse_value () may reallocate open_containers
+    if (is_object)
+      parse_key ();
+    parse_value ();
+  }
+
+  // Appends the value at pos. Containers are only opened here; build ()
+  // parses their elements, so nesting does not recurse.
+  void
+  parse_value ()
+  {
+    skip_whitespace (input, pos);
+    if (pos >= input.size ())
+      fail ("Unexpected end of json data", pos);
+    switch (input[pos])
+      {
+      case '{':
+      case '[':
+        open_containers.push_back (
+            { words.size (), 0, input[pos] == '{', false });
+        words.push_back (make_word (input[pos]));
+        ++pos;
+        return;
+      case '"':
+        parse_string ();
+        return;
+      case 't':
+        parse_literal ("true", 't');
+        return;
+      case 'f':
+        parse_literal ("false", 'f');
+        return;
+      case 'n':
+        parse_literal ("null", 'n');
+        return;
+      default:
+        parse_number ();
+        return;
+      }
+  }
+
+  void
+  close_container ()
+  {
+    const open_container container{ open_containers.back () };
+    open_containers.pop_back ();
+    words.push_back (make_word (container.is_object ? '}' : ']',
+                                container.count & payload_mask));
+    words[container.word_index] |= words.size ();
+  }
+
+  void
+  parse_key ()
+  {
+    skip_whitespace (input, pos);
+    if (pos >= input.size () || input[pos] != '"')
+      fail ("Expected '\"' for a JSON object key", pos);
+    parse_string ();
+    skip_whitespace (input, pos);
+    if (pos >= input.size () || input[pos] != ':')
+      fail ("Expected ':' in JSON object", pos);
+    ++pos;
+  }
+
+  void
+  parse_string ()
+  {
+    const size_t start{ ++pos };
+    while (true)
+      {
+        const size_t special{ input.find_first_of ("\"\\", pos) };
+        if (special == std::string_view::npos)
+          fail ("Unterminated json string data", start - 1);
+        if (input[special] == '"')
+          {
+            pos = special;
+            break;
+          }
+        pos = special + 2;
+      }
+    words.push_back (make_word ('s', strings.size ()));
+    words.push_back (pos - start);
+    strings.insert (strings.end (), input.data () + start, input.data () + pos);
+    ++pos;
+  }
+
+  void
+  parse_literal (const std::string_view literal, const char tag)
+  {
+    if (input.compare (pos, literal.size (), literal) != 0)
+      fail ("Invalid json value", pos);
+    pos += literal.size ();
+    words.push_back (make_word (tag));
+  }
+
+  // Scans the RFC 8259 grammar: no leading zeros, digits on both sides of
+  // the '.' and after the exponent.
+  void
+  parse_number ()
+  {
+    const size_t start{ pos };
+    const auto skip_digits = [this] () {
+      const size_t first{ pos };
+      while (pos < input.size () && input[pos] >= '0' && input[pos] <= '9')
+        ++pos;
+      return pos - first;
+    };
+    if (input[pos] == '-')
+      ++pos;
+    if (pos < input.size () && input[pos] == '0')
+      ++pos;
+    else if (skip_digits () == 0)
+      fail (pos == start ? "Invalid json value" : "Invalid json number",
+            start);
+    if (pos < input.size () && input[pos] == '.')
+      {
+        ++pos;
+        if (skip_digits () == 0)
+          fail ("Invalid json number", start);
+      }
+    if (pos < input.size () && (input[pos] == 'e' || input[pos] == 'E'))
+      {
+        ++pos;
+        if (pos < input.size () && (input[pos] == '+' || input[pos] == '-'))
+          ++pos;
+        if (skip_digits () == 0)
+          fail ("Invalid json number", start);
+      }
+    if (pos < input.size () && is_number_char (input[pos]))
+      fail ("Invalid json number", start);
+    double number{};
+    const auto [ptr, ec] = std::from_chars (input.data () + start,
+                                            input.data () + pos, number);
+    if (ec != std::errc{} || ptr != input.data () + pos)
+      fail ("Invalid json number", start);
+    words.push_back (make_word ('d'));
+    words.push_back (std::bit_cast<std::uint64_t> (number));
+  }
+
+  const std::string_view input;
+  std::vector<std::uint64_t> &words;
+  std::vector<char> &strings;
+  std::vector<open_container> open_containers;
+  size_t pos{};
+};
+
+} // namespace
+
+json_type
+json_tape_view::get_json_element_type () const noexcept
+{
+  switch (tag ())
+    {
+    case 't':
+    case 'f':
+      return json_type::boolean_t;
+    case 'd':
+      return json_type::number_t;
+    case 's':
+      return json_type::string_t;
+    case '[':
+      return json_type::array_t;
+    case '{':
+      return json_type::object_t;
+    default:
+      return json_type::null_t;
+    }
+}
+
+std::optional<bool>
+json_tape_view::get_json_value_as_bool () const noexcept
+{
+  if (is_json_boolean ())
+    return to_bool ();
+  return std::nullopt;
+}
+
+std::optional<double>
+json_tape_view::get_json_value_as_number () const noexcept
+{
+  if (is_json_number ())
+    return to_number ();
+  return std::nullopt;
+}
+
+std::optional<std::string_view>
+json_tape_view::get_json_value_as_string () const noexcept
+{
+  if (!is_json_string ())
+    return std::nullopt;
+  return std::string_view{ strings + payload (),
+                           static_cast<size_t> (words[index + 1]) };
+}
+
+size_t
+json_tape_view::size () const noexcept
+{
+  if (!is_json_array () && !is_json_object ())
+    return 0;
+  return static_cast<size_t> (words[payload () - 1] & payload_mask);
+}
+
+std::optional<json_tape_view>
+json_tape_view::find (const std::string_view key) const noexcept
+{
+  std::optional<json_tape_view> found;
+  for (const json_tape_member &member : items ())
+    if (member.key == key)
+      found = member.value;
+  return found;
+}
+
+json_tape_view
+json_tape_view::at (const std::string_view key) const
+{
+  if (!is_json_object ())
+    throw std::invalid_argument ("JSON element is not a JSON object!");
+  if (const std::optional<json_tape_view> value = find (key))
+    return *value;
+  throw std::out_of_range{ std::format (
+      "JSON element with key {} is not found!", key) };
+}
+
+json_tape_view::member_iterator
+json_tape_view::begin () const noexcept
+{
+  return member_iterator{ is_json_object () ? at_index (index + 1)
+                                            : json_tape_view{} };
+}
+
+json_tape_view::member_iterator
+json_tape_view::end () const noexcept
+{
+  return member_iterator{ is_json_object () ? at_index (payload () - 1)
+                                            : json_tape_view{} };
+}
+
+Json
+json_tape_view::to_json () const
+{
+  switch (tag ())
+    {
+    case 't':
+    case 'f':
+      return Json{ to_bool () };
+    case 'd':
+      return Json{ to_number () };
+    case 's':
+      return Json{ std::string{ *get_json_value_as_string () } };
+    case '[':
+      {
+        std::vector<Json> elements;
+        elements.reserve (size ());
+        for (const json_tape_view element : values ())
+          elements.push_back (element.to_json ());
+        return Json{ std::move (elements) };
+      }
+    case '{':
+      {
+        std::unordered_map<std::string, Json> members;
+        members.reserve (size ());
+        for (const auto &[key, value] : items ())
+          members.insert_or_assign (std::string{ key }, value.to_json ());
+        return Json{ std::move (members) };
+      }
+    default:
+      return Json{ nullptr };
+    }
+}
+
+json_tape
+parse_tape (const std::string_view input)
+{
+  json_tape tape;
+  tape.words.clear ();
+  tape_builder{ input, tape.words, tape.strings }.build ();
+  return tape;
+}
+
+} // namespace simple_json
@@ -1,14 +1,62 @@
 #include "../include/simple_json.h"
+#include "../include/simple_json_async.h"
+#include "../include/simple_json_binding.h"
+#include "../include/simple_json_cache.h"
+#include "../include/simple_json_index.h"
+#include "../include/simple_json_compact.h"
+#include "../include/simple_json_literal.h"
+#include "../include/simple_json_parallel.h"
+#include "../include/simple_json_patch.h"
+#include "../include/simple_json_path.h"
+#include "../include/simple_json_schema.h"
+#include "../include/simple_json_snapshot.h"
+#include "../include/simple_json_tape.h"
 
+#include <algorithm>
 #include <cmath>
+#include <coroutine>
+#include <cstring>
+#include <deque>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 using namespace std;
 using namespace simple_json;
 
+struct test_address
+{
+  std::string city;
+  std::string zip;
+};
+
+SIMPLE_JSON_FIELDS (test_address, city, zip)
+
+struct test_person
+{
+  std::string name;
+  int age{};
+  bool is_student{};
+  std::vector<double> scores;
+  std::optional<test_address> address;
+  std::optional<std::string> nickname;
+};
+
+SIMPLE_JSON_FIELDS (test_person, name, age, is_student, scores, address,
+                    nickname)
+
+struct test_document
+{
+  std::string name;
+  Json extra;
+};
+
+SIMPLE_JSON_FIELDS (test_document, name, extra)
+
 TEST (simple_json_library, creating_a_default_json_object)
 {
   Json json;
@@ -281,6 +329,1360 @@ TEST (simple_json_library,
   ASSERT_EQ (json_zip_value, "90001");
 }
 
+TEST (simple_json_library, parsing_json_data_directly_into_a_struct)
+{
+  const auto person{ parse_as<test_person> (
+      R"({
+        "name": "Alice \"Al\" Smith",
+        "age": 25,
+        "unknown": { "nested": [1, "]", { "x": null }] },
+        "is_student": true,
+        "scores": [88.5, 92, 79],
+        "address": {
+            "city": "Los Angeles",
+            "zip": "90001"
+        },
+        "nickname": null
+    })") };
+
+  ASSERT_EQ (person.name, "Alice \"Al\" Smith");
+  ASSERT_EQ (person.age, 25);
+  ASSERT_TRUE (person.is_student);
+  ASSERT_EQ (person.scores, (std::vector<double>{ 88.5, 92, 79 }));
+  ASSERT_TRUE (person.address.has_value ());
+  ASSERT_EQ (person.address->city, "Los Angeles");
+  ASSERT_EQ (person.address->zip, "90001");
+  ASSERT_FALSE (person.nickname.has_value ());
+
+  ASSERT_THROW (parse_as<test_person> (R"({"age": 25.5})"),
+                std::invalid_argument);
+  ASSERT_THROW (parse_as<test_person> (R"({"name": "Bob")"),
+                std::invalid_argument);
+
+  // unbound members are skipped, but still have to be valid JSON
+  ASSERT_EQ (parse_as<test_person> (
+                 R"({"zz": {"q": [1, -2.5e3, true, null, "\"]"]}, "age": 3})")
+                 .age,
+             3);
+  for (const std::string_view text :
+       { R"({"zz": tru})", R"({"zz": {"q" 1 2}})", R"({"zz": [1 2]})",
+         R"({"zz": {"q": 1,}})", R"({"zz": [1,]})", R"({"zz": 1.2.3})",
+         R"({"zz": nul})", R"({"zz": {"q": 1})", R"({"zz": "x)" })
+    ASSERT_THROW (parse_as<test_person> (text), std::invalid_argument)
+        << text;
+  ASSERT_THROW (parse_as<test_person> (std::string_view{ "{\"zz\":[\0]}", 10 }),
+                std::invalid_argument);
+  ASSERT_THROW (parse_as<test_person> (std::string_view{ "{\"age\":1\0}", 10 }),
+                std::invalid_argument);
+}
+
+TEST (simple_json_library, serializing_a_struct_directly_to_json_string)
+{
+  const test_person person{ "Bob",         31,
+                            false,         { 1.5, 2 },
+                            test_address{ "Paris", "75001" },
+                            std::nullopt };
+  const std::string json_string{ to_json_string (person) };
+  ASSERT_EQ (json_string,
+             R"({"name":"Bob","age":31,"is_student":false,"scores":[1.5,2],)"
+             R"("address":{"city":"Paris","zip":"75001"},"nickname":null})");
+
+  const auto round_trip{ parse_as<test_person> (json_string) };
+  ASSERT_EQ (round_trip.name, person.name);
+  ASSERT_EQ (round_trip.scores, person.scores);
+  ASSERT_EQ (round_trip.address->city, "Paris");
+
+  // Json members are written as JSON text, strings as parse () stores them
+  const test_document document{
+    "a", parse (R"({"n": [1, 2.5, 123456789.125], "k": "v\nw", "t": true,
+                    "z": null, "e": {}, "l": [[], {"x": "y"}]})")
+             .result_value.value ()
+  };
+  const auto document_round_trip{ parse_as<test_document> (
+      to_json_string (document)) };
+  ASSERT_EQ (document_round_trip.name, "a");
+  ASSERT_EQ (document_round_trip.extra, document.extra);
+  ASSERT_TRUE (parse_as<std::vector<test_document> > (
+                   R"([{"name": "c"}])")[0]
+                   .extra.is_json_null ());
+
+  parse_options options;
+  options.typed_numeric_arrays = true;
+  const test_document numbers{
+    "b", parse ("[0.1, 3, -2e-7]", options).result_value.value ()
+  };
+  ASSERT_EQ (to_json_string (numbers),
+             R"({"name":"b","extra":[0.1,3,-2e-07]})");
+}
+
+TEST (simple_json_library, validating_json_literals_at_compile_time)
+{
+  static_assert (is_valid_json (R"({"a": [1, 2.5e3, -0.25], "b": null})"));
+  static_assert (is_valid_json (R"("escaped \"quote\" \u00e9")"));
+  static_assert (!is_valid_json (R"({"a": 1,})"));
+  static_assert (!is_valid_json (R"({"a" 1})"));
+  static_assert (!is_valid_json (R"([01])"));
+  static_assert (!is_valid_json (R"([1] 2)"));
+
+  const Json json = R"({"name": "Alice", "age": 25})"_json_checked;
+  ASSERT_EQ (json.get_child_as_json_string ("name")->get (), "Alice");
+  ASSERT_EQ (json.get_child_as_json_number ("age").value (), 25);
+}
+
+TEST (simple_json_library, building_json_from_compile_time_tokenized_literal)
+{
+  static constexpr auto document = R"({
+        "name": "Alice",
+        "age": 25,
+        "is_student": true,
+        "scores": [88.5, 92, 79, 1.25e-3, 12345678901234567890],
+        "address": {
+            "city": "Los Angeles",
+            "zip": "90001"
+        },
+        "spouse": null
+    })"_json_compiled;
+  static_assert (document.size () == 22);
+  static_assert (document.token (0).kind == json_token_kind::object_t);
+  static_assert (document.token (0).length == 6);
+
+  const Json json = document.to_json ();
+  ASSERT_EQ (json.get_child_as_json_string ("name")->get (), "Alice");
+  ASSERT_EQ (json.get_child_as_json_number ("age").value (), 25);
+  ASSERT_TRUE (json.get_child_as_json_boolean ("is_student").value ());
+  ASSERT_TRUE (json.get_child_element_as_json_null ("spouse").has_value ());
+
+  const auto expected{ parse (document.text ()) };
+  const auto &scores{ json.get_child_as_json_array ("scores")->get () };
+  const auto &expected_scores{
+    expected.result_value->get_child_as_json_array ("scores")->get ()
+  };
+  ASSERT_EQ (scores.size (), 5);
+  ASSERT_EQ (scores[0].to_number (), 88.5);
+  ASSERT_EQ (scores[3].to_number (), 1.25e-3);
+  ASSERT_EQ (scores[4].to_number (), 12345678901234567890.0);
+  ASSERT_EQ (json.get_child_as_json_object ("address")->get ().at ("zip")
+                 .to_string (),
+             "90001");
+  ASSERT_EQ (expected_scores[1].to_number (), scores[1].to_number ());
+}
+
+#ifdef SIMPLE_JSON_ENABLE_STATISTICS
+TEST (simple_json_library, collecting_parser_and_serializer_statistics)
+{
+  std::vector<json_statistics> reported;
+  set_statistics_callback ([&] (const json_statistics &statistics) {
+    reported.push_back (statistics);
+  });
+
+  const std::string input{
+    R"({"name": "a string that does not fit into the small buffer",)"
+    R"( "scores": [1, 2, 3, [true, null]], "address": {"zip": "90001"}})"
+  };
+  const auto result{ parse (input) };
+  ASSERT_EQ (result.result_status, status::success);
+  ASSERT_EQ (reported.size (), 1);
+  const json_statistics &parse_statistics{ reported.front () };
+  ASSERT_EQ (parse_statistics.operation, json_operation::parse);
+  ASSERT_EQ (parse_statistics.bytes_processed, input.size ());
+  ASSERT_EQ (parse_statistics.node_counts[static_cast<size_t> (
+                 json_type::object_t)],
+             2);
+  ASSERT_EQ (parse_statistics.node_counts[static_cast<size_t> (
+                 json_type::array_t)],
+             2);
+  ASSERT_EQ (parse_statistics.node_counts[static_cast<size_t> (
+                 json_type::number_t)],
+             3);
+  ASSERT_EQ (parse_statistics.max_depth, 3);
+  ASSERT_EQ (parse_statistics.largest_array, 4);
+  ASSERT_EQ (parse_statistics.largest_object, 3);
+  ASSERT_GT (parse_statistics.allocation_count, 0);
+
+  const std::string output{ result.result_value->to_string (2) };
+  ASSERT_EQ (reported.size (), 2);
+  ASSERT_EQ (reported.back ().operation, json_operation::serialize);
+  ASSERT_EQ (reported.back ().bytes_processed, output.size ());
+  ASSERT_EQ (reported.back ().max_depth, 3);
+  ASSERT_EQ (last_statistics ().operation, json_operation::serialize);
+
+  set_statistics_callback (nullptr);
+}
+#endif
+
+TEST (simple_json_library, copying_shared_json_is_copy_on_write)
+{
+  Json document = parse (R"({
+        "config": {"threads": 64, "name": "workers"},
+        "limits": {"rps": 1000, "burst": [1, 2, 3]}
+    })")
+                      .result_value.value ();
+  document.share ();
+  ASSERT_TRUE (document.is_shared ());
+  ASSERT_TRUE (std::as_const (document).at ("limits").is_shared ());
+
+  const Json snapshot = document;
+  ASSERT_EQ (&snapshot.get_json_value_as_variant (),
+             &document.get_json_value_as_variant ());
+
+  Json modified = snapshot;
+  modified["config"]["threads"] = Json{ 8 };
+  ASSERT_FALSE (modified.is_shared ());
+  ASSERT_EQ (modified["config"]["threads"].to_number (), 8);
+  ASSERT_EQ (snapshot["config"]["threads"].to_number (), 64);
+  ASSERT_EQ (std::as_const (document)["config"]["threads"].to_number (), 64);
+
+  // untouched subtrees are still shared between all three documents
+  ASSERT_EQ (
+      &std::as_const (modified).at ("limits").get_json_value_as_variant (),
+      &snapshot.at ("limits").get_json_value_as_variant ());
+  ASSERT_EQ (&std::as_const (modified)
+                  .at ("config")
+                  .at ("name")
+                  .get_json_value_as_variant (),
+             &snapshot.at ("config").at ("name").get_json_value_as_variant ());
+  ASSERT_EQ (modified.at ("config").get_child_as_json_string ("name")->get (),
+             "workers");
+}
+
+TEST (simple_json_library, iterating_non_object_json_values_is_empty)
+{
+  const Json json_array{ Json{ 1 }, Json{ 2 } };
+  const Json json_number{ 3.5 };
+  ASSERT_TRUE (json_array.begin () == json_array.end ());
+  ASSERT_TRUE (json_number.cbegin () == json_number.cend ());
+}
+
+TEST (simple_json_library, reading_frozen_json_snapshots_while_reloading)
+{
+  json_snapshot_holder holder{ frozen_json{
+      parse (R"({"version": 0, "name": "config"})").result_value.value () } };
+
+  std::atomic<bool> is_done{};
+  std::atomic<size_t> inconsistent_reads{};
+  std::vector<std::thread> readers;
+  for (size_t i{}; i < 4; ++i)
+    readers.emplace_back ([&] {
+      auto reader{ holder.get_reader () };
+      double last_version{};
+      while (!is_done.load ())
+        {
+          const frozen_json &snapshot{ reader.get () };
+          const double version{ snapshot["version"].to_number () };
+          if (version < last_version
+              || snapshot.get ().get_child_as_json_string ("name")->get ()
+                     != "config")
+            ++inconsistent_reads;
+          last_version = version;
+        }
+    });
+
+  for (int version{ 1 }; version <= 200; ++version)
+    holder.update (
+        [&] (Json &json) { json["version"] = Json{ version }; });
+  is_done = true;
+  for (auto &reader : readers)
+    reader.join ();
+
+  ASSERT_EQ (inconsistent_reads.load (), 0);
+  ASSERT_EQ (holder.load ()["version"].to_number (), 200);
+  ASSERT_EQ (holder.version (), 200);
+
+  Json thawed{ holder.load ().thaw () };
+  thawed["name"] = Json{ "changed" };
+  ASSERT_EQ (holder.load ().at ("name").to_string (), "config");
+}
+
+TEST (simple_json_library, resolving_json_pointers)
+{
+  Json json = parse (R"({"a/b": [10, {"m~n": true}], "": 1})")
+                  .result_value.value ();
+  ASSERT_EQ (split_json_pointer ("/a~1b/1/m~0n"),
+             (vector<string>{ "a/b", "1", "m~n" }));
+  ASSERT_EQ (append_json_pointer ("/a~1b", "m~n"), "/a~1b/m~0n");
+  ASSERT_EQ (find_json_pointer (json, ""), &json);
+  ASSERT_EQ (find_json_pointer (json, "/a~1b/0")->to_number (), 10);
+  ASSERT_TRUE (find_json_pointer (json, "/a~1b/1/m~0n")->to_bool ());
+  ASSERT_EQ (find_json_pointer (json, "/")->to_number (), 1);
+  ASSERT_EQ (find_json_pointer (json, "/a~1b/01"), nullptr);
+  ASSERT_EQ (find_json_pointer (json, "/missing"), nullptr);
+  ASSERT_THROW (find_json_pointer (json, "a"), std::invalid_argument);
+  ASSERT_THROW (find_json_pointer (json, "/~2"), std::invalid_argument);
+}
+
+TEST (simple_json_library, diffing_and_patching_json_documents)
+{
+  const Json source = parse (R"({"name": "node", "tags": [1, 2, 3, 4, 5],
+      "meta": {"version": 1, "removed": null}})")
+                          .result_value.value ();
+  const Json target = parse (R"({"name": "node", "tags": [1, 3, 4, 6, 5],
+      "meta": {"version": 2, "added": true}})")
+                          .result_value.value ();
+
+  const json_patch patch{ diff (source, target) };
+  ASSERT_EQ (patch.size (), 5u);
+  ASSERT_TRUE (diff (source, source).empty ());
+
+  Json document = source;
+  apply_patch (document, json_patch_from_json (json_patch_to_json (patch)));
+  ASSERT_TRUE (diff (document, target).empty ());
+  ASSERT_EQ (document["tags"].get_json_value_as_array ()->get ().size (), 5u);
+  // only the paths the patch touched were copied
+  ASSERT_TRUE (find_json_pointer (std::as_const (document), "/name")->is_shared ());
+  ASSERT_FALSE (find_json_pointer (std::as_const (document), "/meta")->is_shared ());
+  ASSERT_EQ (document["meta"]["version"].to_number (), 2);
+
+  const json_patch failing_patch{
+    { json_patch_op::move, "/renamed", "/name" },
+    { json_patch_op::add, "/tags/-", {}, Json{ 7 } },
+    { json_patch_op::test, "/meta/version", {}, Json{ 3 } }
+  };
+  ASSERT_THROW (apply_patch (document, failing_patch), std::invalid_argument);
+  ASSERT_TRUE (diff (document, target).empty ());
+
+  // long arrays with many scattered edits
+  std::vector<Json> long_source;
+  std::vector<Json> long_target;
+  for (int i{}; i < 20000; ++i)
+    {
+      long_source.emplace_back (i);
+      if (i % 7 == 0)
+        long_target.emplace_back (-i);
+      else if (i % 5 != 0)
+        long_target.emplace_back (i);
+      if (i % 11 == 0)
+        long_target.emplace_back (i + 0.5);
+    }
+  Json long_document{ std::move (long_source) };
+  const Json long_expected{ std::move (long_target) };
+  apply_patch (long_document, diff (long_document, long_expected));
+  ASSERT_EQ (long_document, long_expected);
+}
+
+TEST (simple_json_library, applying_json_merge_patches)
+{
+  const std::string_view patch_text{
+    R"({"a": "z", "c": {"f": null, "g": {"h": null, "i": [1]}}, "d": null})"
+  };
+  const Json original = parse (R"({"a": "b", "c": {"d": "e", "f": "g"},
+      "d": 1})")
+                            .result_value.value ();
+  const Json patch = parse (patch_text).result_value.value ();
+  const Json expected = parse (R"({"a": "z", "c": {"d": "e", "g": {"i": [1]}}})")
+                            .result_value.value ();
+
+  Json copied_patch_target = original;
+  merge_patch (copied_patch_target, patch);
+  ASSERT_TRUE (diff (copied_patch_target, expected).empty ());
+
+  Json moved_patch_target = original;
+  Json moved_patch = patch;
+  merge_patch (moved_patch_target, std::move (moved_patch));
+  ASSERT_TRUE (diff (moved_patch_target, expected).empty ());
+
+  Json streamed_patch_target = original;
+  merge_patch_from_string (streamed_patch_target, patch_text);
+  ASSERT_TRUE (diff (streamed_patch_target, expected).empty ());
+
+  ASSERT_THROW (merge_patch_from_string (streamed_patch_target,
+                                         R"({"a": null, "b": })"),
+                std::invalid_argument);
+  ASSERT_TRUE (diff (streamed_patch_target, expected).empty ());
+
+  // keys are matched as parse () stores them, escapes included
+  Json escaped_key_target
+      = parse (R"({"a\nb": 1, "c": 2})").result_value.value ();
+  merge_patch_from_string (escaped_key_target, R"({"a\nb": null, "d\t": 3})");
+  ASSERT_EQ (escaped_key_target,
+             parse (R"({"c": 2, "d\t": 3})").result_value.value ());
+
+  merge_patch (streamed_patch_target, Json{ 5 });
+  ASSERT_EQ (streamed_patch_target.to_number (), 5);
+}
+
+TEST (simple_json_library, comparing_and_hashing_json_values)
+{
+  const Json first = parse (R"({"a": [1, 2, {"b": null}], "c": "d", "e": 0})")
+                         .result_value.value ();
+  const Json reordered = parse (R"({"e": -0, "c": "d", "a": [1, 2, {"b": null}]})")
+                             .result_value.value ();
+  const Json different = parse (R"({"a": [1, 2, {"b": false}], "c": "d", "e": 0})")
+                             .result_value.value ();
+
+  ASSERT_TRUE (first == reordered);
+  ASSERT_EQ (std::hash<Json>{}(first), std::hash<Json>{}(reordered));
+  ASSERT_TRUE (first != different);
+  ASSERT_TRUE (Json{ 1 } != Json{ "1" });
+  ASSERT_TRUE ((Json{ Json{ 1 }, Json{ 2 } } != Json{ Json{ 1 } }));
+
+  std::unordered_set<Json> documents{ first, reordered, different };
+  ASSERT_EQ (documents.size (), 2u);
+
+  Json shared = first;
+  shared.share ();
+  const size_t shared_hash{ shared.hash () };
+  Json modified = shared;
+  ASSERT_TRUE (modified == shared);
+  modified["c"] = Json{ "changed" };
+  ASSERT_TRUE (modified != shared);
+  ASSERT_NE (modified.hash (), shared_hash);
+  ASSERT_EQ (shared.hash (), shared_hash);
+  ASSERT_EQ (shared_hash, first.hash ());
+}
+
+TEST (simple_json_library, reserializing_only_modified_shared_subtrees)
+{
+  const std::string_view input{
+    R"({"users": [{"name": "a", "age": 30}, {"name": "b", "age": 40}],
+        "settings": {"theme": "dark", "limits": [1, 2, 3]}})"
+  };
+  Json tracked = parse (input).result_value.value ();
+  Json untracked = parse (input).result_value.value ();
+  tracked.share ();
+  ASSERT_EQ (tracked.to_string (2), untracked.to_string (2));
+
+  tracked["settings"]["theme"] = Json{ "light" };
+  untracked["settings"]["theme"] = Json{ "light" };
+  ASSERT_FALSE (tracked.is_shared ());
+  ASSERT_FALSE (std::as_const (tracked)["settings"].is_shared ());
+  ASSERT_TRUE (std::as_const (tracked)["users"].is_shared ());
+  ASSERT_EQ (tracked.to_string (2), untracked.to_string (2));
+  ASSERT_EQ (tracked.to_string (), untracked.to_string ());
+
+  tracked.share ();
+  ASSERT_TRUE (std::as_const (tracked)["settings"].is_shared ());
+  ASSERT_EQ (tracked.to_string (2), untracked.to_string (2));
+}
+
+TEST (simple_json_library, caching_parsed_documents_by_content)
+{
+  ASSERT_EQ (hash_json_input (""), 0xEF46DB3751D8E999ULL);
+  ASSERT_EQ (hash_json_input ("abc"), 0x44BC2CF5AD770999ULL);
+
+  json_parse_cache cache{ 4096 };
+  const std::string message{ R"({"id": 1, "tags": ["a", "b"]})" };
+  const frozen_json first{ cache.parse (message) };
+  const frozen_json second{ cache.parse (std::string{ message }) };
+  ASSERT_EQ (&first.get (), &second.get ());
+  ASSERT_EQ (cache.hits (), 1u);
+  ASSERT_EQ (cache.misses (), 1u);
+  ASSERT_EQ (first["id"].to_number (), 1);
+  ASSERT_THROW (cache.parse ("[1, 2"), std::invalid_argument);
+  ASSERT_EQ (cache.entry_count (), 1u);
+
+  for (int i{}; i < 200; ++i)
+    cache.parse (std::format (R"({{"id": {}}})", i));
+  ASSERT_LE (cache.size_bytes (), cache.capacity ());
+  ASSERT_LT (cache.entry_count (), 200u);
+  ASSERT_EQ (cache.parse (R"({"id": 199})")["id"].to_number (), 199);
+  ASSERT_EQ (cache.hits (), 2u);
+}
+
+TEST (simple_json_library, validating_json_against_a_compiled_schema)
+{
+  const json_schema schema{ parse (R"({
+      "type": "object",
+      "required": ["id", "name"],
+      "additionalProperties": false,
+      "properties": {
+        "id": {"type": "integer", "minimum": 1},
+        "name": {"type": "string", "minLength": 2, "pattern": "^[a-z]+$"},
+        "role": {"enum": ["admin", "user"]},
+        "scores": {"type": "array", "maxItems": 3,
+                   "items": {"type": "number", "exclusiveMaximum": 100}},
+        "address": {"type": "object", "required": ["city"],
+                    "properties": {"city": {"type": "string"}}}
+      }})")
+                                .result_value.value () };
+
+  const std::string_view valid{ R"({"id": 7, "name": "alice", "role": "user",
+      "scores": [1.5, 99], "address": {"city": "Paris", "zip": "75001"}})" };
+  ASSERT_FALSE (schema.validate (valid).has_value ());
+  ASSERT_FALSE (
+      schema.validate (parse (valid).result_value.value ()).has_value ());
+  ASSERT_EQ (schema.parse (valid).result_value->at ("id").to_number (), 7);
+
+  const auto expect_violation = [&] (const std::string_view input,
+                                     const std::string &path) {
+    const auto text_violation{ schema.validate (input) };
+    ASSERT_TRUE (text_violation.has_value ()) << input;
+    ASSERT_EQ (text_violation->path, path) << text_violation->message;
+    const auto tree_violation{ schema.validate (
+        parse (input).result_value.value ()) };
+    ASSERT_TRUE (tree_violation.has_value ()) << input;
+    ASSERT_EQ (tree_violation->path, path) << tree_violation->message;
+  };
+  expect_violation (R"({"id": 1.5, "name": "bob"})", "/id");
+  expect_violation (R"({"id": 0, "name": "bob"})", "/id");
+  expect_violation (R"({"id": 1, "name": "Bob"})", "/name");
+  expect_violation (R"({"id": 1})", "");
+  expect_violation (R"({"id": 1, "name": "bob", "role": "root"})", "/role");
+  expect_violation (R"({"id": 1, "name": "bob", "extra": 1})", "/extra");
+  expect_violation (R"({"id": 1, "name": "bob", "scores": [1, 100]})",
+                    "/scores/1");
+  expect_violation (R"({"id": 1, "name": "bob", "scores": [1, 2, 3, 4]})",
+                    "/scores");
+  expect_violation (R"({"id": 1, "name": "bob", "address": {}})",
+                    "/address");
+
+  ASSERT_EQ (schema.parse (R"({"id": 1})").result_status, status::fail);
+  ASSERT_TRUE (schema.validate (R"({"id": 1, "name": )").has_value ());
+
+  // text and tree validation measure strings as parse () stores them
+  const json_schema short_name{
+    parse (R"({"properties": {"name": {"maxLength": 1}}})").result_value.value ()
+  };
+  const std::string_view escaped{ R"({"name": "\u00e9"})" };
+  ASSERT_TRUE (short_name.validate (escaped).has_value ());
+  ASSERT_TRUE (
+      short_name.validate (parse (escaped).result_value.value ()).has_value ());
+  ASSERT_EQ (short_name.parse (escaped).result_status, status::fail);
+  ASSERT_TRUE (
+      short_name.validate (std::string_view{ "{\"x\":[\0]}", 9 }).has_value ());
+  ASSERT_THROW (json_schema{ parse (R"({"$ref": "#/x"})").result_value.value () },
+                std::invalid_argument);
+
+  const json_schema counted{ parse (
+      R"({"properties": {"step": {"multipleOf": 0.1}},
+          "minProperties": 1, "maxProperties": 2})")
+                                 .result_value.value () };
+  for (const std::string_view valid :
+       { R"({"step": 1.5})", R"({"step": -2, "x": 1})", R"({"step": 0.3})",
+         R"({"x": 1, "x": 2})" })
+    {
+      ASSERT_FALSE (counted.validate (valid).has_value ()) << valid;
+      ASSERT_FALSE (
+          counted.validate (parse (valid).result_value.value ()).has_value ())
+          << valid;
+    }
+  for (const std::string_view invalid :
+       { R"({"step": 0.25})", "{}", R"({"step": 1, "x": 1, "y": 1})" })
+    {
+      ASSERT_TRUE (counted.validate (invalid).has_value ()) << invalid;
+      ASSERT_TRUE (
+          counted.validate (parse (invalid).result_value.value ()).has_value ())
+          << invalid;
+    }
+  // a repeated key is validated as parse () keeps it: the last member wins
+  const json_schema natural{
+    parse (R"({"properties": {"n": {"minimum": 0}}})").result_value.value ()
+  };
+  for (const std::string_view input :
+       { R"({"n": -1, "n": 1})", R"({"n": {"x": [1, -2]}, "n": 1})" })
+    {
+      ASSERT_FALSE (natural.validate (input).has_value ()) << input;
+      ASSERT_FALSE (
+          natural.validate (parse (input).result_value.value ()).has_value ())
+          << input;
+      ASSERT_EQ (natural.parse (input).result_status, status::success);
+    }
+  const auto repeated_violation{ natural.validate (R"({"n": 1, "n": -1})") };
+  ASSERT_TRUE (repeated_violation.has_value ());
+  ASSERT_EQ (repeated_violation->path, "/n");
+  ASSERT_TRUE (natural.validate (R"({"n": -1, "n": 1,})").has_value ());
+
+  for (const std::string_view unsupported :
+       { R"({"uniqueItems": true})", R"({"contains": {}})",
+         R"({"propertyNames": {}})", R"({"dependentRequired": {}})",
+         R"({"multipleOf": 0})" })
+    ASSERT_THROW (json_schema{ parse (unsupported).result_value.value () },
+                  std::invalid_argument)
+        << unsupported;
+}
+
+TEST (simple_json_library, parsing_only_selected_json_pointers)
+{
+  const std::string_view input{ R"({
+      "skipped": {"text": "a \\\" quoted ] brace }", "list": [[1, 2], {"x": "]"}]},
+      "user": {"id": 42, "name": "alice", "tags": ["a", "b", "c"]},
+      "items": [{"price": 1.5}, {"price": 2.5}],
+      "after": [1, 2, 3]})" };
+  const auto [json_value, json_status, error_msg] = parse_selected (
+      input, { "/user/id", "/items/1/price", "/user/tags", "/user/tags/2",
+               "/missing", "/items/7" });
+  ASSERT_EQ (json_status, status::success) << error_msg;
+  const Json &selected{ json_value.value () };
+  ASSERT_EQ (selected.get_json_value_as_object ()->get ().size (), 4u);
+  ASSERT_EQ (selected.at ("/user/id").to_number (), 42);
+  ASSERT_EQ (selected.at ("/items/1/price").to_number (), 2.5);
+  ASSERT_EQ (selected.at ("/user/tags").get_json_value_as_array ()->get ().size (),
+             3u);
+  ASSERT_EQ (selected.at ("/user/tags/2").to_string (), "c");
+
+  size_t pos{};
+  const std::string_view skipped{ R"({"a": "x\\\"}]", "b": [1, {"c": []}]} ,)" };
+  ASSERT_TRUE (skip_json_value (skipped, pos));
+  ASSERT_EQ (skipped.substr (pos), " ,");
+
+  ASSERT_EQ (parse_selected (R"({"a": [1, 2)", { "/b" }).result_status,
+             status::fail);
+
+  // a repeated key selects its first member, and only once
+  const Json duplicated = parse_selected (R"({"a": 1, "a": {"x": 2}, "b": 3})",
+                                          { "/a", "/b", "/a/x" })
+                              .result_value.value ();
+  ASSERT_EQ (duplicated.get_json_value_as_object ()->get ().size (), 2u);
+  ASSERT_EQ (duplicated.at ("/a").to_number (), 1);
+  ASSERT_EQ (duplicated.at ("/b").to_number (), 3);
+  ASSERT_EQ (parse_selected (R"({"a": {"x": 1}, "a": {"x": 2}, "b": 3})",
+                            { "/a/x", "/b" })
+                 .result_value.value (),
+             parse (R"({"/a/x": 1, "/b": 3})").result_value.value ());
+}
+
+TEST (simple_json_library, iterating_json_with_range_views)
+{
+  static_assert (std::ranges::forward_range<Json>);
+  static_assert (std::forward_iterator<Json::const_value_iterator>);
+  static_assert (
+      std::ranges::view<decltype (std::declval<const Json &> ().as_numbers ())>);
+
+  Json numbers = parse ("[1, 2, \"x\", 4]").result_value.value ();
+  double sum{};
+  for (const Json &element : numbers.values ())
+    if (element.is_json_number ())
+      sum += element.to_number ();
+  ASSERT_EQ (sum, 7);
+  ASSERT_EQ (std::ranges::count_if (numbers.values (),
+                                    [] (const Json &element) {
+                                      return element.is_json_string ();
+                                    }),
+             1);
+
+  auto positive = numbers.as_numbers ()
+                  | std::views::filter ([] (double n) { return n > 1; });
+  ASSERT_EQ (std::ranges::distance (positive), 2);
+
+  for (Json &element : numbers.values ())
+    if (element.is_json_number ())
+      element = Json{ element.to_number () * 2 };
+  sum = 0;
+  for (const double n : numbers.as_numbers ())
+    if (!std::isnan (n))
+      sum += n;
+  ASSERT_EQ (sum, 14);
+
+  const Json object = parse (R"({"a": 1, "b": 2})").result_value.value ();
+  std::vector<std::string> keys (object.keys ().begin (), object.keys ().end ());
+  std::ranges::sort (keys);
+  ASSERT_EQ (keys, (std::vector<std::string>{ "a", "b" }));
+  ASSERT_EQ (std::ranges::distance (object.values ()), 2);
+  ASSERT_TRUE (Json{ 1.0 }.values ().empty ());
+  ASSERT_TRUE (numbers.keys ().empty ());
+}
+
+TEST (simple_json_library, running_parallel_algorithms_over_arrays)
+{
+  std::vector<Json> records;
+  for (int i{}; i < 10000; ++i)
+    records.push_back (Json{ std::unordered_map<std::string, Json>{
+        { "id", Json{ i } }, { "score", Json{ (i * 7919) % 1000 } } } });
+  records.push_back (Json{ std::unordered_map<std::string, Json>{} });
+  Json array{ std::move (records) };
+
+  ASSERT_EQ (parallel_reduce (
+                 array, 0.0, std::plus<> (),
+                 [] (const Json &record) {
+                   const Json *id{ find_json_pointer (record, "/id") };
+                   return id != nullptr ? id->to_number () : 0.0;
+                 }),
+             49995000);
+  ASSERT_EQ (parallel_count_if (array,
+                                [] (const Json &record) {
+                                  const Json *score{ find_json_pointer (
+                                      record, "/score") };
+                                  return score != nullptr
+                                         && score->to_number () < 100;
+                                }),
+             1000u);
+
+  parallel_for_each (array, [] (Json &record) {
+    record["seen"] = Json{ true };
+  });
+  const Json seen = parallel_transform (
+      array, [] (const Json &record) { return record.at ("seen"); });
+  ASSERT_EQ (parallel_count_if (seen,
+                                [] (const Json &flag) { return flag.to_bool (); }),
+             10001u);
+
+  parallel_sort_by (array, "/score");
+  const std::vector<Json> &sorted{ array.get_json_value_as_array ()->get () };
+  ASSERT_EQ (find_json_pointer (sorted.front (), "/score"), nullptr);
+  for (size_t i{ 2 }; i < sorted.size (); ++i)
+    {
+      const double previous{ sorted[i - 1].at ("score").to_number () };
+      const double current{ sorted[i].at ("score").to_number () };
+      ASSERT_LE (previous, current);
+      if (previous == current)
+        {
+          ASSERT_LT (sorted[i - 1].at ("id").to_number (),
+                     sorted[i].at ("id").to_number ());
+        }
+    }
+
+  ASSERT_THROW (parallel_count_if (Json{ 1.0 },
+                                   [] (const Json &) { return true; }),
+                std::invalid_argument);
+  ASSERT_THROW (parallel_for_each (array,
+                                   [] (Json &record) {
+                                     if (record["id"].to_number () == 5000)
+                                       throw std::runtime_error{ "stop" };
+                                   }),
+                std::runtime_error);
+}
+
+namespace
+{
+
+// Event loop stand-in: suspended coroutines are queued and resumed in turn.
+std::deque<std::coroutine_handle<> > pending_coroutines;
+
+struct chunk_source
+{
+  std::deque<std::string> *chunks;
+
+  auto
+  operator() () const
+  {
+    struct awaiter
+    {
+      std::deque<std::string> *chunks;
+
+      bool
+      await_ready () const noexcept
+      {
+        return false;
+      }
+
+      void
+      await_suspend (std::coroutine_handle<> handle) const
+      {
+        pending_coroutines.push_back (handle);
+      }
+
+      std::optional<std::string>
+      await_resume () const
+      {
+        if (chunks->empty ())
+          return std::nullopt;
+        std::string chunk{ std::move (chunks->front ()) };
+        chunks->pop_front ();
+        return chunk;
+      }
+    };
+    return awaiter{ chunks };
+  }
+};
+
+struct detached_task
+{
+  struct promise_type
+  {
+    detached_task
+    get_return_object () const noexcept
+    {
+      return {};
+    }
+
+    std::suspend_never
+    initial_suspend () const noexcept
+    {
+      return {};
+    }
+
+    std::suspend_never
+    final_suspend () const noexcept
+    {
+      return {};
+    }
+
+    void
+    return_void () const noexcept
+    {
+    }
+
+    void
+    unhandled_exception () const noexcept
+    {
+      std::terminate ();
+    }
+  };
+};
+
+detached_task
+collect_values (json_value_stream stream, std::vector<Json> &values,
+                std::string &error)
+{
+  try
+    {
+      while (std::optional<Json> json = co_await stream.next ())
+        values.push_back (std::move (*json));
+    }
+  catch (const std::invalid_argument &e)
+    {
+      error = e.what ();
+    }
+}
+
+} // namespace
+
+TEST (simple_json_library, parsing_chunks_with_coroutines)
+{
+  const std::string input{ R"([{"a": "x[y]}"}, 12, true, "s,", [1, [2]] ])" };
+  std::deque<std::string> chunks;
+  for (size_t i{}; i < input.size (); i += 3)
+    chunks.push_back (input.substr (i, 3));
+
+  std::vector<Json> values;
+  std::string error;
+  collect_values (parse_async (chunk_source{ &chunks },
+                               json_stream_mode::array_elements),
+                  values, error);
+  size_t resumptions{};
+  while (!pending_coroutines.empty ())
+    {
+      const std::coroutine_handle<> handle{ pending_coroutines.front () };
+      pending_coroutines.pop_front ();
+      handle.resume ();
+      ++resumptions;
+    }
+  ASSERT_TRUE (error.empty ()) << error;
+  ASSERT_GT (resumptions, input.size () / 3);
+  ASSERT_EQ (values.size (), 5u);
+  ASSERT_EQ (values[0].at ("a").to_string (), "x[y]}");
+  ASSERT_EQ (values[1].to_number (), 12);
+  ASSERT_TRUE (values[2].to_bool ());
+  ASSERT_EQ (values[3].to_string (), "s,");
+  ASSERT_EQ (values[4].get_json_value_as_array ()->get ().size (), 2u);
+
+  json_stream_splitter splitter;
+  std::vector<Json> documents;
+  for (const char ch : std::string_view{ "{\"id\": 1}\n{\"id\": 2}\n3" })
+    {
+      splitter.feed (std::string_view{ &ch, 1 });
+      while (std::optional<Json> json = splitter.next ())
+        documents.push_back (std::move (*json));
+    }
+  ASSERT_EQ (documents.size (), 2u);
+  splitter.finish ();
+  ASSERT_EQ (splitter.next ()->to_number (), 3);
+  ASSERT_FALSE (splitter.next ().has_value ());
+  ASSERT_TRUE (splitter.is_done ());
+
+  chunks = { "[1 ", "2]" };
+  values.clear ();
+  collect_values (parse_async (chunk_source{ &chunks },
+                               json_stream_mode::array_elements),
+                  values, error);
+  while (!pending_coroutines.empty ())
+    {
+      const std::coroutine_handle<> handle{ pending_coroutines.front () };
+      pending_coroutines.pop_front ();
+      handle.resume ();
+    }
+  ASSERT_EQ (values.size (), 1u);
+  ASSERT_FALSE (error.empty ());
+}
+
+TEST (simple_json_library, validating_utf8_and_parsing_other_encodings)
+{
+  ASSERT_TRUE (is_valid_utf8 ("plain ascii text that is longer than 16"));
+  ASSERT_TRUE (is_valid_utf8 ("caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80"));
+  ASSERT_FALSE (is_valid_utf8 ("\xC3"));             // truncated
+  ASSERT_FALSE (is_valid_utf8 ("\xC0\xAF"));         // overlong
+  ASSERT_FALSE (is_valid_utf8 ("\xED\xA0\x80"));     // surrogate
+  ASSERT_FALSE (is_valid_utf8 ("\xF4\x90\x80\x80")); // past U+10FFFF
+
+  const std::string_view invalid{ "{\"name\": \"caf\xC3\"}" };
+  ASSERT_EQ (parse (invalid).result_status, status::success);
+  // like other malformed nested values, this throws
+  ASSERT_THROW (parse (invalid, parse_options{ .validate_utf8 = true }),
+                std::invalid_argument);
+  ASSERT_EQ (parse ("\"caf\xC3\"", parse_options{ .validate_utf8 = true })
+                 .result_status,
+             status::fail);
+  ASSERT_EQ (parse ("{\"k\xFF\": 1}", parse_options{ .validate_utf8 = true })
+                 .result_status,
+             status::fail);
+
+  const auto expect_name = [] (const result_type &result) {
+    ASSERT_EQ (result.result_status, status::success) << result.result_string;
+    ASSERT_EQ (result.result_value->at ("name").to_string (),
+               "caf\xC3\xA9 \xF0\x9F\x98\x80");
+  };
+  expect_name (parse (u8R"({"name": "café 😀"})"));
+  expect_name (parse (uR"({"name": "café 😀"})"));
+  expect_name (parse (UR"({"name": "café 😀"})"));
+  expect_name (parse (LR"({"name": "café 😀"})"));
+
+  ASSERT_EQ (parse (std::u16string{ u'[', u'"', char16_t{ 0xD800 }, u'"', u']' })
+                 .result_status,
+             status::fail);
+  ASSERT_EQ (parse (std::u32string{ U'[', char32_t{ 0x110000 }, U']' })
+                 .result_status,
+             status::fail);
+}
+
+TEST (simple_json_library, keeping_raw_number_text_with_lazy_numbers)
+{
+  const parse_options options{ .lazy_numbers = true };
+  const std::string_view input{
+    R"([12345678901234567890, 3.14159265358979323846, 1E+2, -0, 0.5])"
+  };
+  auto [json_value, json_status, error_msg] = parse (input, options);
+  ASSERT_EQ (json_status, status::success) << error_msg;
+  Json &numbers{ json_value.value () };
+  const std::vector<Json> &elements{ numbers.get_json_value_as_array ()->get () };
+  ASSERT_EQ (std::get<json_raw_number> (elements[0].get_json_value_as_variant ())
+                 .text,
+             "12345678901234567890");
+  ASSERT_TRUE (elements[1].is_json_number ());
+  ASSERT_EQ (elements[1].get_json_element_type (), json_type::number_t);
+  ASSERT_DOUBLE_EQ (elements[1].to_number (), 3.14159265358979323846);
+  ASSERT_EQ (elements[2].get_json_value_as_number (), 100);
+  ASSERT_EQ (numbers.to_string (),
+             "[\n12345678901234567890,\n3.14159265358979323846,\n1E+2,\n-0,\n"
+             "0.5,\n]");
+
+  // raw and converted numbers compare and hash alike
+  ASSERT_EQ (elements[4], Json{ 0.5 });
+  ASSERT_EQ (elements[4].hash (), Json{ 0.5 }.hash ());
+  ASSERT_EQ (elements[3], Json{ 0.0 });
+
+  numbers.get_json_value_as_array ()->get ()[2] = Json{ 7 };
+  ASSERT_EQ (numbers.get_json_value_as_array ()->get ()[2].to_string (), "7");
+
+  ASSERT_EQ (parse ("1.", options).result_status, status::fail);
+  ASSERT_EQ (parse ("01", options).result_status, status::fail);
+  ASSERT_EQ (parse ("-", options).result_status, status::fail);
+  ASSERT_EQ (parse ("2e-3", options).result_value->to_number (), 0.002);
+}
+
+TEST (simple_json_library, limiting_resources_for_hostile_input)
+{
+  const auto expect_failure
+      = [] (const std::string_view input, const parse_options &options,
+            const std::string_view message) {
+          try
+            {
+              const auto result{ parse (input, options) };
+              ASSERT_EQ (result.result_status, status::fail);
+              ASSERT_EQ (result.result_string, message);
+            }
+          catch (const std::invalid_argument &e)
+            {
+              ASSERT_EQ (std::string_view{ e.what () }, message);
+            }
+        };
+  expect_failure (std::string (100000, '['), parse_options{ .max_depth = 64 },
+                  "Maximum nesting depth of 64 exceeded at offset 64!");
+  ASSERT_EQ (parse ("[[1]]", parse_options{ .max_depth = 2 }).result_status,
+             status::success);
+  expect_failure ("[1, 2, 3]", parse_options{ .max_input_bytes = 8 },
+                  "Maximum input size of 8 bytes exceeded: the input has 9 "
+                  "bytes!");
+  expect_failure (R"({"key": "a long string value"})",
+                  parse_options{ .max_string_length = 10 },
+                  "Maximum string length of 10 exceeded at offset 9!");
+  expect_failure (R"({"a long key name": 1})",
+                  parse_options{ .max_string_length = 10 },
+                  "Maximum string length of 10 exceeded at offset 2!");
+  expect_failure ("[1, 2, 3, 4]", parse_options{ .max_element_count = 4 },
+                  "Maximum element count of 4 exceeded at offset 10!");
+  // the element slot fits, its string does not
+  const size_t allocation_limit{ sizeof (Json) + 16 };
+  expect_failure (R"(["a string that needs a heap allocation"])",
+                  parse_options{ .max_allocated_bytes = allocation_limit },
+                  "Maximum allocated bytes of "
+                      + std::to_string (allocation_limit)
+                      + " exceeded at offset 2!");
+  expect_failure ("[1, 2]",
+                  parse_options{ .deadline = std::chrono::steady_clock::now ()
+                                             - std::chrono::seconds{ 1 } },
+                  "Parse deadline exceeded at offset 0!");
+
+  std::string many{ "[" };
+  for (int i{}; i < 10000; ++i)
+    many += "1,";
+  many += "1]";
+  ASSERT_EQ (parse (many,
+                    parse_options{ .max_depth = 4,
+                                   .max_element_count = 20000,
+                                   .max_allocated_bytes = 1 << 20,
+                                   .deadline = std::chrono::steady_clock::now ()
+                                               + std::chrono::minutes{ 1 } })
+                 .result_status,
+             status::success);
+
+  // a non-string key used to make the object parser spin forever
+  ASSERT_EQ (parse ("{1: 2}").result_status, status::fail);
+}
+
+TEST (simple_json_library, reusing_a_parser_across_calls)
+{
+  const std::string_view message{
+    R"({"id": 7, "user": {"name": "a name longer than the small buffer"},
+        "tags": ["first", "second"], "id": 8})"
+  };
+  parser json_parser;
+  auto [first, first_status, first_error] = json_parser.parse (message);
+  ASSERT_EQ (first_status, status::success) << first_error;
+  ASSERT_EQ (*first, parse (message).result_value.value ());
+  ASSERT_EQ (first->at ("id").to_number (), 8);
+
+  const Json *tags_buffer{
+    first->at ("tags").get_json_value_as_array ()->get ().data ()
+  };
+  json_parser.recycle (std::move (*first));
+  ASSERT_EQ (json_parser.pooled ().arrays.size (), 1u);
+  ASSERT_EQ (json_parser.pooled ().objects.size (), 2u);
+  ASSERT_EQ (json_parser.pooled ().members.size (), 4u);
+  ASSERT_EQ (json_parser.pooled ().strings.size (), 1u);
+
+  const auto [second, second_status, second_error]
+      = json_parser.parse (message);
+  ASSERT_EQ (second_status, status::success) << second_error;
+  ASSERT_EQ (second->at ("tags").get_json_value_as_array ()->get ().data (),
+             tags_buffer);
+  ASSERT_EQ (second->at ("user").at ("name").to_string (),
+             "a name longer than the small buffer");
+  ASSERT_TRUE (json_parser.pooled ().arrays.empty ());
+  ASSERT_TRUE (json_parser.pooled ().members.empty ());
+
+  Json shared = parse (R"({"a": [1, 2]})").result_value.value ();
+  shared.share ();
+  const Json copy = shared;
+  json_parser.recycle (std::move (shared));
+  ASSERT_TRUE (json_parser.pooled ().arrays.empty ());
+  ASSERT_EQ (copy.at ("a").get_json_value_as_array ()->get ().size (), 2u);
+
+  parser limited{ parse_options{ .max_depth = 1 } };
+  ASSERT_THROW (limited.parse ("[[1]]"), std::invalid_argument);
+}
+
+TEST (simple_json_library, compacting_a_document_into_16_byte_nodes)
+{
+  const Json json = parse (R"({"name": "short", "text": "a string too long to be inlined",
+                               "values": [1, 2.5, true, null, {}], "nested": {"b": 1, "a": [false]}})")
+                        .result_value.value ();
+  const compact_document document{ json };
+  const compact_json &root{ document.root () };
+
+  ASSERT_TRUE (root.is_json_object ());
+  ASSERT_EQ (root.size (), 4);
+  ASSERT_EQ (*root["name"].get_json_value_as_string (), "short");
+  ASSERT_EQ (*root.at ("text").get_json_value_as_string (),
+             "a string too long to be inlined");
+  ASSERT_EQ (root["values"].get_json_element_type (), json_type::array_t);
+  ASSERT_EQ (root["values"].get_json_value_as_array ()->size (), 5);
+  ASSERT_DOUBLE_EQ (find_json_pointer (root, "/values/1")->to_number (), 2.5);
+  ASSERT_TRUE (find_json_pointer (root, "/values/2")->to_bool ());
+  ASSERT_TRUE (find_json_pointer (root, "/values/3")->is_json_null ());
+  ASSERT_EQ (find_json_pointer (root, "/values/5"), nullptr);
+  ASSERT_FALSE (find_json_pointer (root, "/nested/a/0")->to_bool ());
+  ASSERT_TRUE (root["missing"].is_json_null ());
+  ASSERT_EQ (root.find ("missing"), nullptr);
+  ASSERT_THROW (root.at ("missing"), std::out_of_range);
+  ASSERT_THROW (root["name"].at ("x"), std::invalid_argument);
+
+  // members are kept sorted by key
+  const auto members = root["nested"].get_json_value_as_object ();
+  ASSERT_EQ (*members->front ().key.get_json_value_as_string (), "a");
+  ASSERT_EQ (*members->back ().key.get_json_value_as_string (), "b");
+
+  ASSERT_EQ (document.to_json (), json);
+
+  // copies share the arena, so nodes stay valid with any copy alive
+  const compact_json *name{ &root["name"] };
+  compact_document copy{ document };
+  ASSERT_EQ (&copy.root (), &root);
+  ASSERT_EQ (*name->get_json_value_as_string (), "short");
+
+  // only the long string and the child blocks come from the arena
+  ASSERT_EQ (document.allocated_bytes (),
+             31 + 4 * sizeof (compact_member) + 5 * sizeof (compact_json)
+                 + 2 * sizeof (compact_member) + sizeof (compact_json));
+  ASSERT_TRUE (compact_document{}->is_json_null ());
+}
+
+TEST (simple_json_library, storing_numeric_arrays_contiguously)
+{
+  parse_options options;
+  options.typed_numeric_arrays = true;
+  const std::string input{
+    R"({"series": [1, 2.5, -3e2, 123456789012, -0.125, 7],
+        "mixed": [1, 2, "three", 4], "nested": [[1, 2], [], [3]]})"
+  };
+  const Json typed = parse (input, options).result_value.value ();
+  const Json generic = parse (input).result_value.value ();
+
+  const auto series = typed["series"].get_json_value_as_numbers ();
+  ASSERT_TRUE (series.has_value ());
+  ASSERT_EQ (std::vector<double> (series->begin (), series->end ()),
+             (std::vector<double>{ 1, 2.5, -300, 123456789012, -0.125, 7 }));
+  ASSERT_TRUE (typed["series"].is_json_array ());
+  ASSERT_EQ (typed["series"].get_json_element_type (), json_type::array_t);
+  ASSERT_FALSE (typed["mixed"].get_json_value_as_numbers ().has_value ());
+  ASSERT_EQ (typed["mixed"], generic["mixed"]);
+  ASSERT_TRUE (find_json_pointer (typed, "/nested/0")
+                   ->get_json_value_as_numbers ()
+                   .has_value ());
+  ASSERT_DOUBLE_EQ (find_json_pointer (typed, "/series/1")->to_number (), 2.5);
+
+  // typed and generic arrays compare, hash and print alike
+  ASSERT_EQ (typed, generic);
+  ASSERT_EQ (generic, typed);
+  ASSERT_EQ (typed.hash (), generic.hash ());
+  ASSERT_EQ (typed["series"].to_string (2), generic["series"].to_string (2));
+
+  // non-const array access turns the numbers into Json elements
+  Json copy = typed;
+  copy["series"].get_json_value_as_array ()->get ().emplace_back ("x");
+  ASSERT_FALSE (copy["series"].get_json_value_as_numbers ().has_value ());
+  ASSERT_EQ (copy["series"].get_json_value_as_array ()->get ().size (), 7);
+  ASSERT_TRUE (typed["series"].get_json_value_as_numbers ().has_value ());
+
+  // changing the numbers drops the elements built from them
+  Json numbers{ json_number_array{ { 1, 2, 3 } } };
+  ASSERT_EQ (std::as_const (numbers).get_json_value_as_array ()->get ().size (),
+             3u);
+  numbers.as<json_number_array> ().mutable_values ().push_back (4);
+  ASSERT_EQ (std::as_const (numbers).get_json_value_as_array ()->get ().size (),
+             4u);
+  ASSERT_DOUBLE_EQ (
+      std::as_const (numbers).get_json_value_as_array ()->get ().back ().to_number (),
+      4);
+
+  ASSERT_DOUBLE_EQ (sum_numbers (*series), 123456788722.375);
+  ASSERT_DOUBLE_EQ (min_number (*series), -300);
+  ASSERT_DOUBLE_EQ (max_number (*series), 123456789012);
+  ASSERT_TRUE (std::isnan (min_number ({})));
+  ASSERT_EQ (sum_numbers ({}), 0);
+
+  // raw number text takes precedence, limits still apply
+  options.lazy_numbers = true;
+  ASSERT_FALSE (parse ("[1, 2]", options)
+                    .result_value->get_json_value_as_numbers ()
+                    .has_value ());
+  options.lazy_numbers = false;
+  options.max_element_count = 3;
+  ASSERT_THROW (parse ("[1, 2, 3]", options), std::invalid_argument);
+}
+
+TEST (simple_json_library, reading_a_document_from_a_tape)
+{
+  const std::string input{
+    R"({"name": "tape", "count": 3, "ok": true, "none": null,
+        "items": [1.5, "two", [], {}, [[3]]], "nested": {"a": {"b": false}}})"
+  };
+  json_tape tape{ parse_tape (input) };
+  const json_tape_view root{ tape.root () };
+
+  ASSERT_TRUE (root.is_json_object ());
+  ASSERT_EQ (root.size (), 6);
+  ASSERT_EQ (*root["name"].get_json_value_as_string (), "tape");
+  ASSERT_DOUBLE_EQ (root.at ("count").to_number (), 3);
+  ASSERT_TRUE (root["ok"].to_bool ());
+  ASSERT_TRUE (root["none"].is_json_null ());
+  ASSERT_FALSE (root["nested"]["a"]["b"].to_bool ());
+  ASSERT_TRUE (root["nested"]["a"]["b"].is_json_boolean ());
+  ASSERT_TRUE (root["missing"].is_json_null ());
+  ASSERT_THROW (root.at ("missing"), std::out_of_range);
+  ASSERT_THROW (root["name"].at ("x"), std::invalid_argument);
+
+  const json_tape_view items{ root["items"] };
+  ASSERT_EQ (items.get_json_element_type (), json_type::array_t);
+  ASSERT_EQ (items.size (), 5);
+  ASSERT_EQ (std::ranges::distance (items.values ()), 5);
+  ASSERT_EQ (std::ranges::count_if (items.values (), &json_tape_view::is_json_array), 2);
+  ASSERT_TRUE (items.items ().empty ());
+  const json_tape_view last{ *std::next (items.values ().begin (), 4) };
+  ASSERT_EQ ((*last.values ().begin ()).size (), 1);
+
+  std::vector<std::string_view> keys;
+  for (const auto &[key, value] : root)
+    keys.push_back (key);
+  std::ranges::sort (keys);
+  ASSERT_EQ (keys, (std::vector<std::string_view>{ "count", "items", "name",
+                                                   "nested", "none", "ok" }));
+  ASSERT_EQ (std::ranges::distance (root.keys ()), 6);
+
+  // one word per value and container end, two per string and number
+  ASSERT_EQ (tape.word_count (), 45);
+  ASSERT_EQ (tape.to_json (), parse (input).result_value.value ());
+
+  // moving the tape keeps views valid
+  const json_tape moved{ std::move (tape) };
+  ASSERT_EQ (*root["name"].get_json_value_as_string (), "tape");
+
+  ASSERT_THROW (parse_tape ("[1, 2,]"), std::invalid_argument);
+  ASSERT_THROW (parse_tape ("{\"a\" 1}"), std::invalid_argument);
+  ASSERT_THROW (parse_tape ("[1] 2"), std::invalid_argument);
+  ASSERT_THROW (parse_tape ("[[1]"), std::invalid_argument);
+  ASSERT_THROW (parse_tape ("[1.2.3]"), std::invalid_argument);
+  for (const std::string_view number : { "01", "1.", "-", "-01", ".5", "1e",
+                                         "1e+", "+1", "0x1", "1.e5" })
+    ASSERT_THROW (parse_tape (number), std::invalid_argument) << number;
+  for (const std::string_view number : { "0", "-0", "10", "0.5", "-1.25e-3",
+                                         "1E+2", "[0,-0.0]" })
+    ASSERT_NO_THROW (parse_tape (number)) << number;
+  ASSERT_TRUE (parse_tape ("  7 ").root ().is_json_number ());
+  ASSERT_EQ (*parse_tape (R"("a\"b")").root ().get_json_value_as_string (),
+             "a\\\"b");
+  ASSERT_EQ (parse_tape (std::string (100000, '[') + std::string (100000, ']'))
+                 .word_count (),
+             200000);
+}
+
+TEST (simple_json_library, querying_json_with_compiled_json_paths)
+{
+  Json json = parse (R"({"orders": [
+      {"id": "a", "total": 250, "items": [{"sku": "x1"}, {"sku": "x2"}]},
+      {"id": "b", "total": 80, "items": [{"sku": "y1"}]},
+      {"id": "c", "total": 120.5, "items": [], "note": "rush order"}],
+    "limit": 100, "tags": ["n", "m"]})")
+                  .result_value.value ();
+
+  const json_path skus{ "$.orders[?@.total > 100].items[*].sku" };
+  std::vector<std::string> selected;
+  for (const Json *sku : skus.select (std::as_const (json)))
+    selected.push_back (sku->get_json_value_as_string ()->get ());
+  ASSERT_EQ (selected, (std::vector<std::string>{ "x1", "x2" }));
+  ASSERT_FALSE (skus.is_singular ());
+
+  // references, not copies
+  ASSERT_EQ (json_path{ "$.orders[0]" }.select (std::as_const (json)),
+             (std::vector<const Json *>{
+                 find_json_pointer (std::as_const (json), "/orders/0") }));
+  ASSERT_TRUE (json_path{ "$.orders[-1]['id']" }.is_singular ());
+
+  const auto ids = [&json] (const std::string_view query) {
+    std::vector<std::string> found;
+    for (const Json *id : json_path{ query }.select (std::as_const (json)))
+      found.push_back (id->get_json_value_as_string ()->get ());
+    return found;
+  };
+  using ids_type = std::vector<std::string>;
+  ASSERT_EQ (ids ("$.orders[?@.total > $.limit && !@.note].id"),
+             ids_type{ "a" });
+  ASSERT_EQ (ids ("$.orders[?@.total < 100 || length(@.items) == 0].id"),
+             (ids_type{ "b", "c" }));
+  ASSERT_EQ (ids ("$.orders[?@.note].id"), ids_type{ "c" });
+  ASSERT_EQ (ids ("$.orders[?count(@.items[*]) >= 1].id"),
+             (ids_type{ "a", "b" }));
+  ASSERT_EQ (ids ("$.orders[?match(@.id, '[ab]')].id"), (ids_type{ "a", "b" }));
+  ASSERT_EQ (ids ("$.orders[?search(@.note, 'rush')].id"), ids_type{ "c" });
+  ASSERT_EQ (ids ("$.orders[?value(@..sku) == 'y1'].id"), ids_type{ "b" });
+  ASSERT_EQ (ids ("$.orders[?@.id == 'a' || @.id == \"c\"].id"),
+             (ids_type{ "a", "c" }));
+  ASSERT_EQ (ids ("$.orders[::-2].id"), (ids_type{ "c", "a" }));
+  ASSERT_EQ (ids ("$.orders[1:].id"), (ids_type{ "b", "c" }));
+  ASSERT_EQ (ids ("$.orders[0, 2]['id']"), (ids_type{ "a", "c" }));
+  ASSERT_EQ (ids ("$..sku"), (ids_type{ "x1", "x2", "y1" }));
+  ASSERT_EQ (ids ("$.orders[?@.missing == @.other].id").size (), 3);
+  ASSERT_TRUE (ids ("$.orders[?@.total == '250'].id").empty ());
+  ASSERT_TRUE (ids ("$.orders[5].id").empty ());
+  ASSERT_EQ (json_path{ "$.tags[*]" }.select (std::as_const (json)).size (),
+             2);
+  ASSERT_EQ (json_path{ "$..*" }.select (std::as_const (json)).size (), 24);
+
+  // the same compiled query runs against other documents
+  const Json other = parse (R"({"orders": [{"total": 101, "items": [{"sku": "z"}]}]})")
+                         .result_value.value ();
+  ASSERT_EQ (skus.select (other).size (), 1);
+
+  // mutable selection modifies the document in place
+  for (Json *total : json_path{ "$.orders[*].total" }.select (json))
+    *total = Json{ 0 };
+  ASSERT_TRUE (skus.select (std::as_const (json)).empty ());
+
+  ASSERT_THROW (json_path{ "orders" }, std::invalid_argument);
+  ASSERT_THROW (json_path{ "$.orders[" }, std::invalid_argument);
+  ASSERT_THROW (json_path{ "$[01]" }, std::invalid_argument);
+  ASSERT_THROW (json_path{ "$[?@.a]x" }, std::invalid_argument);
+  ASSERT_THROW (json_path{ "$[?@..a == 1]" }, std::invalid_argument);
+  ASSERT_THROW (json_path{ "$[?length(@.a)]" }, std::invalid_argument);
+  ASSERT_THROW (json_path{ "$[?1]" }, std::invalid_argument);
+  ASSERT_THROW (json_path{ "$[?unknown(@)]" }, std::invalid_argument);
+}
+
+TEST (simple_json_library, indexing_array_elements_by_a_field)
+{
+  Json catalog = parse (R"({"products": [
+      {"sku": "a-1", "price": 10, "meta": {"id": 7}},
+      {"sku": "b-2", "price": 20, "meta": {"id": 8}},
+      {"price": 30},
+      {"sku": "c-3", "price": 40, "meta": {"id": 9}}]})")
+                     .result_value.value ();
+  Json &products{ catalog.get_json_value_as_object ()->get ().at ("products") };
+
+  json_index by_sku{ build_index (products, "/sku") };
+  ASSERT_EQ (by_sku.size (), 3);
+  ASSERT_EQ (by_sku.position ("b-2"), 1);
+  ASSERT_DOUBLE_EQ (by_sku.find ("c-3")->at ("price").to_number (), 40);
+  ASSERT_EQ (by_sku.find ("missing"), nullptr);
+
+  // lookups return the elements themselves
+  by_sku.find ("a-1")->at ("price") = Json{ 15 };
+  ASSERT_DOUBLE_EQ (
+      find_json_pointer (catalog, "/products/0/price")->to_number (), 15);
+
+  const json_index by_id{ products, "/meta/id" };
+  ASSERT_EQ (by_id.size (), 3);
+  ASSERT_EQ (by_id.position (9), 3);
+  ASSERT_EQ (by_id.find ("9"), nullptr);
+
+  by_sku.push_back (parse (R"({"sku": "d-4", "price": 50})").result_value.value ());
+  ASSERT_EQ (by_sku.position ("d-4"), 4);
+  ASSERT_THROW (by_sku.push_back (parse (R"({"sku": "a-1"})").result_value.value ()),
+                std::invalid_argument);
+  ASSERT_EQ (products.get_json_value_as_array ()->get ().size (), 5);
+
+  // swap-remove: the last element takes the place of the removed one
+  ASSERT_TRUE (by_sku.erase ("b-2"));
+  ASSERT_FALSE (by_sku.erase ("b-2"));
+  ASSERT_EQ (by_sku.position ("d-4"), 1);
+  by_sku.erase_at (2);
+  ASSERT_EQ (by_sku.size (), 3);
+  ASSERT_EQ (products.get_json_value_as_array ()->get ().size (), 3);
+  ASSERT_EQ (by_sku.position ("c-3"), 2);
+  ASSERT_THROW (by_sku.erase_at (3), std::out_of_range);
+
+  products.get_json_value_as_array ()->get ().clear ();
+  by_sku.rebuild ();
+  ASSERT_EQ (by_sku.size (), 0);
+
+  Json numbers = parse ("[3, 1, 2]").result_value.value ();
+  ASSERT_EQ (build_index (numbers, "").position (2), 2);
+  Json duplicates = parse (R"([{"k": 1}, {"k": 1}])").result_value.value ();
+  ASSERT_THROW (build_index (duplicates, "/k"), std::invalid_argument);
+  ASSERT_THROW (build_index (catalog, "/sku"), std::invalid_argument);
+}
+
+TEST (simple_json_library, parsing_truncated_input_from_exact_length_views)
+{
+  // copied into exact-size heap buffers, so reading past the end of the
+  // view is caught by sanitizers instead of finding a terminating '\0'
+  const auto is_rejected = [] (const std::string_view text) {
+    const std::unique_ptr<char[]> buffer{ new char[text.size ()] };
+    std::memcpy (buffer.get (), text.data (), text.size ());
+    try
+      {
+        return parse (std::string_view{ buffer.get (), text.size () })
+                   .result_status
+               == status::fail;
+      }
+    catch (const std::invalid_argument &)
+      {
+        return true;
+      }
+  };
+  for (const std::string_view text :
+       { R"({"a":1)", R"({"a":1 )", R"({"a")", R"({"a":1,)", R"({"a":[1)",
+         "[1,2", "[1 ", R"(["x")", "[[1]", "[1,", R"([{"a":1})" })
+    ASSERT_TRUE (is_rejected (text)) << text;
+}
+
 int
 main (int argc, char **argv)
 {